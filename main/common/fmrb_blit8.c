@@ -0,0 +1,209 @@
+#include "fmrb_blit8.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BLIT8_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*key_row_fn_t)(uint8_t *dst, const uint8_t *src, size_t len, uint8_t key);
+
+static void key_row_bytewise(uint8_t *dst, const uint8_t *src, size_t len, uint8_t key) {
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != key) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+// SWAR: per byte, select src where src != key. Words are loaded with memcpy so
+// unaligned rows are fine; the destination is aligned first because Xtensa has
+// no unaligned stores.
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t swar_t;
+#define SWAR_ENGINE "swar64"
+#else
+typedef uint32_t swar_t;
+#define SWAR_ENGINE "swar32"
+#endif
+
+#define SWAR_ONES ((swar_t)-1 / 0xFF)   // 0x0101...
+#define SWAR_LOW7 (SWAR_ONES * 0x7F)    // 0x7F7F...
+#define SWAR_HIGH (SWAR_ONES * 0x80)    // 0x8080...
+
+static void key_row_swar(uint8_t *dst, const uint8_t *src, size_t len, uint8_t key) {
+    size_t i = 0;
+    while (i < len && ((uintptr_t)(dst + i) & (sizeof(swar_t) - 1))) {
+        if (src[i] != key) {
+            dst[i] = src[i];
+        }
+        i++;
+    }
+
+    const swar_t keys = SWAR_ONES * key;
+    for (; i + sizeof(swar_t) <= len; i += sizeof(swar_t)) {
+        swar_t s;
+        memcpy(&s, src + i, sizeof(s));
+        swar_t x = s ^ keys;
+        // High bit of each byte set where x != 0 (no carry crosses bytes)
+        swar_t opaque = (((x & SWAR_LOW7) + SWAR_LOW7) | x) & SWAR_HIGH;
+        if (opaque == SWAR_HIGH) {
+            memcpy(dst + i, &s, sizeof(s));
+            continue;
+        }
+        if (opaque == 0) {
+            continue;
+        }
+        swar_t mask = (opaque >> 7) * 0xFF;
+        swar_t d;
+        memcpy(&d, dst + i, sizeof(d));
+        d = (s & mask) | (d & ~mask);
+        memcpy(dst + i, &d, sizeof(d));
+    }
+
+    key_row_bytewise(dst + i, src + i, len - i, key);
+}
+
+void fmrb_blit8_mask_row(uint8_t *dst, const uint8_t *mask, size_t len, uint8_t fg) {
+    const swar_t fgs = SWAR_ONES * fg;
+    size_t i = 0;
+    for (; i + sizeof(swar_t) <= len; i += sizeof(swar_t)) {
+        swar_t m, d;
+        memcpy(&m, mask + i, sizeof(m));
+        if (m == 0) {
+            continue;
+        }
+        memcpy(&d, dst + i, sizeof(d));
+        d = (fgs & m) | (d & ~m);
+        memcpy(dst + i, &d, sizeof(d));
+    }
+    for (; i < len; i++) {
+        if (mask[i]) {
+            dst[i] = fg;
+        }
+    }
+}
+
+void fmrb_blit8_mask_row_opaque(uint8_t *dst, const uint8_t *mask, size_t len, uint8_t fg, uint8_t bg) {
+    const swar_t fgs = SWAR_ONES * fg;
+    const swar_t bgs = SWAR_ONES * bg;
+    size_t i = 0;
+    for (; i + sizeof(swar_t) <= len; i += sizeof(swar_t)) {
+        swar_t m;
+        memcpy(&m, mask + i, sizeof(m));
+        swar_t d = (fgs & m) | (bgs & ~m);
+        memcpy(dst + i, &d, sizeof(d));
+    }
+    for (; i < len; i++) {
+        dst[i] = mask[i] ? fg : bg;
+    }
+}
+
+#ifdef BLIT8_X86
+static void key_row_sse2(uint8_t *dst, const uint8_t *src, size_t len, uint8_t key) {
+    const __m128i keys = _mm_set1_epi8((char)key);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i transparent = _mm_cmpeq_epi8(s, keys);
+        d = _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, s));
+        _mm_storeu_si128((__m128i*)(dst + i), d);
+    }
+    key_row_bytewise(dst + i, src + i, len - i, key);
+}
+
+__attribute__((target("avx2")))
+static void key_row_avx2(uint8_t *dst, const uint8_t *src, size_t len, uint8_t key) {
+    const __m256i keys = _mm256_set1_epi8((char)key);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i transparent = _mm256_cmpeq_epi8(s, keys);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(s, d, transparent));
+    }
+    key_row_bytewise(dst + i, src + i, len - i, key);
+}
+#endif
+
+static key_row_fn_t key_row_fn = NULL;
+static const char *key_row_engine = NULL;
+
+static void blit8_select(void) {
+#ifdef BLIT8_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        key_row_engine = "avx2";
+        key_row_fn = key_row_avx2;
+        return;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        key_row_engine = "sse2";
+        key_row_fn = key_row_sse2;
+        return;
+    }
+#endif
+    key_row_engine = SWAR_ENGINE;
+    key_row_fn = key_row_swar;
+}
+
+const char *fmrb_blit8_engine(void) {
+    if (!key_row_fn) {
+        blit8_select();
+    }
+    return key_row_engine;
+}
+
+void fmrb_blit8_copy(uint8_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride, int32_t w, int32_t h) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (dst_stride == (size_t)w && src_stride == (size_t)w) {
+        memcpy(dst, src, (size_t)w * h);
+        return;
+    }
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(dst, src, w);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+void fmrb_blit8_copy_key(uint8_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                         int32_t w, int32_t h, uint8_t key) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (!key_row_fn) {
+        blit8_select();
+    }
+    for (int32_t y = 0; y < h; y++) {
+        key_row_fn(dst, src, w, key);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+void fmrb_blit8_copy_key_bytewise(uint8_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                  int32_t w, int32_t h, uint8_t key) {
+    for (int32_t y = 0; y < h; y++) {
+        key_row_bytewise(dst, src, w > 0 ? w : 0, key);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+void fmrb_blit8_fill(uint8_t *dst, size_t dst_stride, int32_t w, int32_t h, uint8_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (dst_stride == (size_t)w) {
+        memset(dst, color, (size_t)w * h);
+        return;
+    }
+    for (int32_t y = 0; y < h; y++) {
+        memset(dst, color, w);
+        dst += dst_stride;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef FMRB_BLIT8_H
+#define FMRB_BLIT8_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 8-bit (RGB332) blit kernels
+ *
+ * Rectangle copy, colour-keyed copy and fill between 1 byte per pixel
+ * buffers, as used by the canvas compositor. Opaque copy and fill are
+ * memcpy/memset per row (one call for contiguous rows). The colour-keyed copy
+ * uses AVX2 or SSE2 on x86 hosts, selected at run time, and word-at-a-time
+ * SWAR elsewhere (32-bit words on Xtensa). Mask rows (text runs from the
+ * glyph atlas) are blended a word at a time.
+ *
+ * Strides are in bytes; rectangles must already be clipped to both buffers.
+ */
+
+/**
+ * @brief Copy a rectangle
+ * @param dst Top-left destination pixel
+ * @param dst_stride Destination row stride
+ * @param src Top-left source pixel
+ * @param src_stride Source row stride
+ * @param w Width in pixels
+ * @param h Height in pixels
+ */
+void fmrb_blit8_copy(uint8_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride, int32_t w, int32_t h);
+
+/**
+ * @brief Copy a rectangle, skipping source pixels equal to the key colour
+ * @param dst Top-left destination pixel
+ * @param dst_stride Destination row stride
+ * @param src Top-left source pixel
+ * @param src_stride Source row stride
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param key Transparent colour (RGB332)
+ */
+void fmrb_blit8_copy_key(uint8_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                         int32_t w, int32_t h, uint8_t key);
+
+/**
+ * @brief Bytewise reference implementation of fmrb_blit8_copy_key() (for verification/benchmarks)
+ */
+void fmrb_blit8_copy_key_bytewise(uint8_t *dst, size_t dst_stride, const uint8_t *src, size_t src_stride,
+                                  int32_t w, int32_t h, uint8_t key);
+
+/**
+ * @brief Fill a rectangle
+ * @param dst Top-left destination pixel
+ * @param dst_stride Destination row stride
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param color Fill colour (RGB332)
+ */
+void fmrb_blit8_fill(uint8_t *dst, size_t dst_stride, int32_t w, int32_t h, uint8_t color);
+
+/**
+ * @brief Paint foreground pixels of a mask row: dst = mask ? fg : dst
+ * @param dst Destination pixels
+ * @param mask Mask bytes, each 0x00 or 0xFF
+ * @param len Number of pixels
+ * @param fg Foreground colour (RGB332)
+ */
+void fmrb_blit8_mask_row(uint8_t *dst, const uint8_t *mask, size_t len, uint8_t fg);
+
+/**
+ * @brief Expand a mask row to two colours: dst = mask ? fg : bg
+ * @param dst Destination pixels
+ * @param mask Mask bytes, each 0x00 or 0xFF
+ * @param len Number of pixels
+ * @param fg Foreground colour (RGB332)
+ * @param bg Background colour (RGB332)
+ */
+void fmrb_blit8_mask_row_opaque(uint8_t *dst, const uint8_t *mask, size_t len, uint8_t fg, uint8_t bg);
+
+/**
+ * @brief Name of the colour-keyed copy engine in use ("avx2", "sse2", "swar64" or "swar32")
+ */
+const char *fmrb_blit8_engine(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMRB_BLIT8_H
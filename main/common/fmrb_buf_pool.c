@@ -0,0 +1,178 @@
+#include "fmrb_buf_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+
+// Size classes: POOL_GRANULE steps up to 4 granules, then four classes per
+// power of two (5, 6, 7, 8, 10, 12, 14, 16, 20, ... granules)
+#define POOL_GRANULE      1024u
+#define POOL_CLASS_COUNT  64
+
+// Each buffer is preceded by a header; a cached buffer links through it
+typedef struct pool_hdr {
+    struct pool_hdr *next;   // Next cached buffer of the class (free list)
+    uint32_t cls;            // Size class index
+    uint32_t requested;      // Requested size (live buffers)
+} pool_hdr_t;
+
+#define POOL_HDR_SIZE FMRB_BUF_POOL_ALIGN  // sizeof(pool_hdr_t) rounded up to keep buffers aligned
+
+static pool_hdr_t *g_free_lists[POOL_CLASS_COUNT];
+static fmrb_buf_pool_stats_t g_stats;
+
+static size_t g_class_sizes[POOL_CLASS_COUNT];
+
+static void pool_init_classes(void) {
+    size_t step = POOL_GRANULE;
+    g_class_sizes[0] = POOL_GRANULE;
+    for (int cls = 1; cls < POOL_CLASS_COUNT; cls++) {
+        g_class_sizes[cls] = g_class_sizes[cls - 1] + step;
+        if (cls >= 7 && (cls & 3) == 3) {
+            step <<= 1;  // Reached a power of two: next four classes double it
+        }
+    }
+}
+
+// Smallest class holding size bytes (header included); -1 if too large
+static int pool_class_of(size_t size) {
+    if (g_class_sizes[0] == 0) {
+        pool_init_classes();
+    }
+    for (int cls = 0; cls < POOL_CLASS_COUNT; cls++) {
+        if (size <= g_class_sizes[cls]) {
+            return cls;
+        }
+    }
+    return -1;
+}
+
+// Class sizes are multiples of POOL_GRANULE, so they satisfy aligned_alloc().
+// malloc() only guarantees 8 bytes on ESP32, hence the aligned variants.
+static void *pool_heap_alloc(size_t size) {
+#ifndef CONFIG_IDF_TARGET_LINUX
+    void *p = heap_caps_aligned_alloc(FMRB_BUF_POOL_ALIGN, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p) {
+        return p;
+    }
+    return heap_caps_aligned_alloc(FMRB_BUF_POOL_ALIGN, size, MALLOC_CAP_8BIT);
+#else
+    return aligned_alloc(FMRB_BUF_POOL_ALIGN, size);
+#endif
+}
+
+static void pool_heap_free(void *p) {
+#ifndef CONFIG_IDF_TARGET_LINUX
+    heap_caps_free(p);
+#else
+    free(p);
+#endif
+}
+
+static pool_hdr_t *pool_take(int cls) {
+    pool_hdr_t *hdr = g_free_lists[cls];
+    if (hdr) {
+        g_free_lists[cls] = hdr->next;
+        g_stats.cached_bytes -= g_class_sizes[cls];
+    }
+    return hdr;
+}
+
+void *fmrb_buf_pool_alloc(size_t size, size_t *capacity) {
+    int cls = pool_class_of(size + POOL_HDR_SIZE);
+    if (cls < 0 || size > UINT32_MAX) {
+        fprintf(stderr, "Buffer pool: %u bytes exceeds the largest size class\n", (unsigned)size);
+        g_stats.failures++;
+        return NULL;
+    }
+    size_t cls_size = g_class_sizes[cls];
+
+    pool_hdr_t *hdr = pool_take(cls);
+    if (hdr) {
+        g_stats.reuses++;
+    } else {
+        hdr = (pool_hdr_t*)pool_heap_alloc(cls_size);
+        if (hdr) {
+            g_stats.heap_allocs++;
+        } else {
+            // Heap exhausted: reuse a larger cached buffer, else drop the cache and retry
+            for (int c = cls + 1; c < POOL_CLASS_COUNT && !hdr; c++) {
+                hdr = pool_take(c);
+                if (hdr) {
+                    cls = c;
+                    cls_size = g_class_sizes[c];
+                    g_stats.reuses++;
+                }
+            }
+            if (!hdr && g_stats.cached_bytes > 0) {
+                fmrb_buf_pool_trim();
+                hdr = (pool_hdr_t*)pool_heap_alloc(cls_size);
+                if (hdr) {
+                    g_stats.heap_allocs++;
+                }
+            }
+            if (!hdr) {
+                fprintf(stderr, "Buffer pool: failed to allocate %u bytes\n", (unsigned)cls_size);
+                g_stats.failures++;
+                return NULL;
+            }
+        }
+    }
+
+    hdr->next = NULL;
+    hdr->cls = (uint32_t)cls;
+    hdr->requested = (uint32_t)size;
+
+    g_stats.allocs++;
+    g_stats.live_buffers++;
+    g_stats.in_use_bytes += cls_size;
+    g_stats.requested_bytes += size;
+    if (g_stats.in_use_bytes + g_stats.cached_bytes > g_stats.peak_bytes) {
+        g_stats.peak_bytes = g_stats.in_use_bytes + g_stats.cached_bytes;
+    }
+
+    if (capacity) {
+        *capacity = cls_size - POOL_HDR_SIZE;
+    }
+    return (uint8_t*)hdr + POOL_HDR_SIZE;
+}
+
+void fmrb_buf_pool_free(void *buf) {
+    if (!buf) {
+        return;
+    }
+    pool_hdr_t *hdr = (pool_hdr_t*)((uint8_t*)buf - POOL_HDR_SIZE);
+    size_t cls_size = g_class_sizes[hdr->cls];
+
+    g_stats.live_buffers--;
+    g_stats.in_use_bytes -= cls_size;
+    g_stats.requested_bytes -= hdr->requested;
+
+    // Above the high-water mark the buffer goes back to the heap
+    if (g_stats.cached_bytes + cls_size > FMRB_BUF_POOL_CACHE_MAX) {
+        pool_heap_free(hdr);
+        return;
+    }
+    g_stats.cached_bytes += cls_size;
+
+    hdr->next = g_free_lists[hdr->cls];
+    g_free_lists[hdr->cls] = hdr;
+}
+
+void fmrb_buf_pool_trim(void) {
+    for (int cls = 0; cls < POOL_CLASS_COUNT; cls++) {
+        pool_hdr_t *hdr;
+        while ((hdr = pool_take(cls)) != NULL) {
+            pool_heap_free(hdr);
+        }
+    }
+}
+
+void fmrb_buf_pool_get_stats(fmrb_buf_pool_stats_t *stats) {
+    if (stats) {
+        *stats = g_stats;
+    }
+}
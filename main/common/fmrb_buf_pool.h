@@ -0,0 +1,79 @@
+#ifndef FMRB_BUF_POOL_H
+#define FMRB_BUF_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alignment of every buffer (SIMD blit kernels)
+#define FMRB_BUF_POOL_ALIGN 16
+
+// Bytes of freed buffers kept for reuse
+#ifdef CONFIG_IDF_TARGET_LINUX
+#define FMRB_BUF_POOL_CACHE_MAX (4u * 1024 * 1024)
+#else
+#define FMRB_BUF_POOL_CACHE_MAX (512u * 1024)
+#endif
+
+/**
+ * Size-class buffer pool for canvas pixel buffers
+ *
+ * Requests are rounded up to a size class (four classes per power of two, so
+ * at most 25% is wasted above 4 KB) and freed buffers are kept on a per-class free list
+ * for the next allocation of that class instead of going back to the heap.
+ * Buffers come from PSRAM on ESP32 when available. The cache is bounded
+ * (FMRB_BUF_POOL_CACHE_MAX): buffers freed above it go back to the heap. When
+ * the heap is exhausted, cached buffers of larger classes are reused and the
+ * cache is trimmed before an allocation fails.
+ *
+ * Not thread-safe: only the graphics task allocates canvas buffers.
+ */
+
+/**
+ * @brief Pool statistics (bytes include the class rounding)
+ */
+typedef struct {
+    size_t in_use_bytes;      // Bytes held by live buffers
+    size_t requested_bytes;   // Bytes requested for live buffers
+    size_t cached_bytes;      // Bytes of freed buffers kept for reuse
+    size_t peak_bytes;        // Peak of in_use_bytes + cached_bytes
+    uint32_t live_buffers;    // Buffers currently allocated
+    uint32_t allocs;          // fmrb_buf_pool_alloc() calls that succeeded
+    uint32_t reuses;          // Allocations served from the cache
+    uint32_t heap_allocs;     // Allocations that went to the heap
+    uint32_t failures;        // Allocations that failed
+} fmrb_buf_pool_stats_t;
+
+/**
+ * @brief Allocate a buffer
+ * @param size Requested size in bytes
+ * @param capacity Output usable size of the buffer (>= size), may be NULL
+ * @return Buffer (FMRB_BUF_POOL_ALIGN-byte aligned), or NULL when out of memory
+ */
+void *fmrb_buf_pool_alloc(size_t size, size_t *capacity);
+
+/**
+ * @brief Return a buffer to the pool (NULL is ignored)
+ * @param buf Buffer from fmrb_buf_pool_alloc()
+ */
+void fmrb_buf_pool_free(void *buf);
+
+/**
+ * @brief Release all cached buffers to the heap
+ */
+void fmrb_buf_pool_trim(void);
+
+/**
+ * @brief Get pool statistics
+ * @param stats Output statistics
+ */
+void fmrb_buf_pool_get_stats(fmrb_buf_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMRB_BUF_POOL_H
@@ -0,0 +1,462 @@
+#include "fmrb_link_bench.h"
+#include "fmrb_link_cobs.h"
+#include "fmrb_link_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "socket_server.h"
+#include "comm_spi.h"
+#else
+#include "esp_timer.h"
+#endif
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+#define BENCH_BYTES_PER_SIZE (64u * 1024 * 1024)
+#else
+#define BENCH_BYTES_PER_SIZE (2u * 1024 * 1024)
+#endif
+
+static const size_t bench_sizes[] = { 16, 64, 256, 1024, 4096, 65536 };
+#define BENCH_SIZE_COUNT (sizeof(bench_sizes) / sizeof(bench_sizes[0]))
+#define BENCH_MAX_SIZE   65536
+
+int64_t fmrb_link_bench_now_us(void) {
+#ifdef CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    return esp_timer_get_time();
+#endif
+}
+
+bool fmrb_link_bench_enabled(const char *name) {
+    const char *list = getenv("FMRB_BENCH");
+#ifdef CONFIG_FMRB_BENCH
+    if (!list) {
+        list = CONFIG_FMRB_BENCH;
+    }
+#endif
+    if (!list) {
+        return false;
+    }
+
+    size_t name_len = strlen(name);
+    for (const char *p = list; *p; ) {
+        size_t len = strcspn(p, ",");
+        if ((len == 3 && strncmp(p, "all", 3) == 0) ||
+            (len == name_len && strncmp(p, name, len) == 0)) {
+            return true;
+        }
+        p += len;
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return false;
+}
+
+typedef uint32_t (*crc32_fn_t)(uint32_t crc, const uint8_t *data, size_t len);
+
+static double bench_crc32_gbps(crc32_fn_t fn, const uint8_t *buf, size_t size, uint32_t *sink) {
+    size_t iterations = BENCH_BYTES_PER_SIZE / size;
+    uint32_t crc = 0;
+
+    int64_t start = fmrb_link_bench_now_us();
+    for (size_t i = 0; i < iterations; i++) {
+        crc = fn(crc, buf, size);
+    }
+    int64_t elapsed = fmrb_link_bench_now_us() - start;
+    *sink ^= crc;
+
+    if (elapsed <= 0) {
+        elapsed = 1;
+    }
+    return (double)(iterations * size) / (double)elapsed / 1000.0;  // bytes/us -> GB/s
+}
+
+void fmrb_link_bench_crc32(void) {
+    uint8_t *buf = (uint8_t*)malloc(BENCH_MAX_SIZE);
+    if (!buf) {
+        printf("CRC32 bench: failed to allocate %d bytes\n", BENCH_MAX_SIZE);
+        return;
+    }
+
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < BENCH_MAX_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+
+    // Both engines must agree before timing anything
+    for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+        if (fmrb_link_crc32_update(0, buf, bench_sizes[i]) !=
+            fmrb_link_crc32_update_bytewise(0, buf, bench_sizes[i])) {
+            printf("CRC32 bench: result mismatch at size %zu\n", bench_sizes[i]);
+            free(buf);
+            return;
+        }
+    }
+
+    printf("=== CRC32 benchmark (engine: %s) ===\n",
+           FMRB_LINK_CRC32_SLICE8 ? "slicing-by-8" : "bytewise table");
+    printf("%8s %12s %12s %8s\n", "size", "bytewise", "engine", "speedup");
+
+    uint32_t sink = 0;
+    for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+        size_t size = bench_sizes[i];
+        double ref = bench_crc32_gbps(fmrb_link_crc32_update_bytewise, buf, size, &sink);
+        double cur = bench_crc32_gbps(fmrb_link_crc32_update, buf, size, &sink);
+        printf("%8zu %9.3f GB/s %7.3f GB/s %7.2fx\n", size, ref, cur, cur / ref);
+    }
+    printf("=== End CRC32 benchmark (sink=0x%08x) ===\n", (unsigned)sink);
+
+    free(buf);
+}
+
+// Bitmap-sized frame (480x320 RGB332) for the COBS + CRC receive path
+#define BENCH_FRAME_SIZE (480 * 320)
+
+void fmrb_link_bench_cobs_crc(void) {
+    size_t enc_cap = COBS_ENC_MAX(BENCH_FRAME_SIZE + FMRB_LINK_CRC_SIZE);
+    uint8_t *src = (uint8_t*)malloc(BENCH_FRAME_SIZE);
+    uint8_t *enc = (uint8_t*)malloc(enc_cap);
+    uint8_t *dec = (uint8_t*)malloc(enc_cap);
+    if (!src || !enc || !dec) {
+        printf("COBS bench: failed to allocate buffers\n");
+        free(src);
+        free(enc);
+        free(dec);
+        return;
+    }
+
+    // Image-like data with some zero runs
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < BENCH_FRAME_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        src[i] = ((seed >> 24) & 7) == 0 ? 0 : (uint8_t)(seed >> 16);
+    }
+    size_t enc_len = fmrb_link_cobs_encode_crc(src, BENCH_FRAME_SIZE, enc) - 1;  // drop terminator
+
+    size_t iterations = BENCH_BYTES_PER_SIZE / BENCH_FRAME_SIZE + 1;
+    uint32_t sink = 0;
+
+    // Two passes: decode, then CRC over the decoded payload
+    int64_t start = fmrb_link_bench_now_us();
+    for (size_t i = 0; i < iterations; i++) {
+        ssize_t n = fmrb_link_cobs_decode(enc, enc_len, dec);
+        sink += fmrb_link_crc32_update(0, dec, n - FMRB_LINK_CRC_SIZE);
+    }
+    int64_t two_pass = fmrb_link_bench_now_us() - start;
+
+    // Fused: CRC folded in while decoding
+    start = fmrb_link_bench_now_us();
+    for (size_t i = 0; i < iterations; i++) {
+        uint32_t crc;
+        fmrb_link_cobs_decode_crc(enc, enc_len, dec, &crc);
+        sink += crc;
+    }
+    int64_t fused = fmrb_link_bench_now_us() - start;
+
+    double bytes = (double)iterations * BENCH_FRAME_SIZE;
+    printf("=== COBS decode + CRC32 benchmark (%d byte frame) ===\n", BENCH_FRAME_SIZE);
+    printf("two-pass: %.3f GB/s\n", bytes / (double)(two_pass > 0 ? two_pass : 1) / 1000.0);
+    printf("fused:    %.3f GB/s\n", bytes / (double)(fused > 0 ? fused : 1) / 1000.0);
+    printf("=== End COBS benchmark (sink=0x%08x) ===\n", (unsigned)sink);
+
+    free(src);
+    free(enc);
+    free(dec);
+}
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+// Request/ACK round trips against the local socket server
+#define ACK_BENCH_WARMUP     32
+#define ACK_BENCH_ITERATIONS 2000
+
+static int compare_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Encode a CONTROL SET_ACK_MODE(EACH) request: idempotent and always ACKed
+static size_t ack_bench_request(uint8_t seq, uint8_t *out) {
+    uint8_t raw[] = {
+        0x94,                            // fixarray(4)
+        FMRB_LINK_TYPE_CONTROL,
+        0xcc, seq,                       // uint8 seq
+        FMRB_LINK_CONTROL_SET_ACK_MODE,
+        0xc4, 1, FMRB_LINK_ACK_MODE_EACH // bin8 payload
+    };
+    return fmrb_link_cobs_encode_crc(raw, sizeof(raw), out);
+}
+
+// Read until the end of one response frame
+static int ack_bench_wait_response(int fd) {
+    uint8_t buf[256];
+    for (;;) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            return -1;
+        }
+        if (buf[n - 1] == COBS_FRAME_TERM) {
+            return 0;
+        }
+    }
+}
+
+static void *ack_bench_thread(void *arg) {
+    (void)arg;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        printf("ACK bench: socket failed\n");
+        return NULL;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SOCKET_SERVER_PATH, sizeof(addr.sun_path) - 1);
+
+    // The server may still be starting
+    int connected = -1;
+    for (int retry = 0; retry < 100 && connected != 0; retry++) {
+        connected = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+        if (connected != 0) {
+            usleep(10000);
+        }
+    }
+
+    int64_t *samples = (int64_t*)malloc(ACK_BENCH_ITERATIONS * sizeof(int64_t));
+    if (connected != 0 || !samples) {
+        printf("ACK bench: failed to connect to %s\n", SOCKET_SERVER_PATH);
+        free(samples);
+        close(fd);
+        return NULL;
+    }
+
+    uint8_t req[32];
+    for (int i = 0; i < ACK_BENCH_WARMUP + ACK_BENCH_ITERATIONS; i++) {
+        size_t len = ack_bench_request((uint8_t)i, req);
+        int64_t start = fmrb_link_bench_now_us();
+        if (write(fd, req, len) != (ssize_t)len || ack_bench_wait_response(fd) != 0) {
+            printf("ACK bench: connection lost after %d requests\n", i);
+            free(samples);
+            close(fd);
+            return NULL;
+        }
+        if (i >= ACK_BENCH_WARMUP) {
+            samples[i - ACK_BENCH_WARMUP] = fmrb_link_bench_now_us() - start;
+        }
+    }
+    close(fd);
+
+    qsort(samples, ACK_BENCH_ITERATIONS, sizeof(int64_t), compare_i64);
+    printf("=== ACK latency benchmark (%d round trips) ===\n", ACK_BENCH_ITERATIONS);
+    printf("p50: %lld us\n", (long long)samples[ACK_BENCH_ITERATIONS / 2]);
+    printf("p99: %lld us\n", (long long)samples[ACK_BENCH_ITERATIONS * 99 / 100]);
+    printf("max: %lld us\n", (long long)samples[ACK_BENCH_ITERATIONS - 1]);
+    printf("=== End ACK latency benchmark ===\n");
+
+    free(samples);
+    return NULL;
+}
+
+// Simulated SPI master: clocks fixed-size transactions against the SPI simulator
+#define SPI_BENCH_LATENCY_ITERATIONS 200
+#define SPI_BENCH_STREAM_FRAMES      512
+#define SPI_BENCH_STREAM_PAYLOAD     1024
+
+typedef struct {
+    int fd;
+    uint8_t *out;          // Pending MOSI stream
+    size_t out_len;
+    size_t out_pos;
+    bool in_frame;         // MISO stream parser state
+    uint32_t frames_in;    // Complete response frames seen on MISO
+    uint32_t xfers;
+} spi_bench_master_t;
+
+static int spi_bench_read_full(int fd, uint8_t *buf, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = read(fd, buf + off, len - off);
+        if (n <= 0) {
+            return -1;
+        }
+        off += n;
+    }
+    return 0;
+}
+
+// One full-duplex transaction: MOSI from the pending stream (0x00 padded)
+static int spi_bench_xfer(spi_bench_master_t *m) {
+    uint8_t mosi[COMM_SPI_XFER_SIZE];
+    uint8_t miso[COMM_SPI_XFER_SIZE];
+
+    size_t n = m->out_len - m->out_pos;
+    if (n > COMM_SPI_XFER_SIZE) {
+        n = COMM_SPI_XFER_SIZE;
+    }
+    memcpy(mosi, m->out + m->out_pos, n);
+    memset(mosi + n, 0, COMM_SPI_XFER_SIZE - n);
+    m->out_pos += n;
+
+    if (write(m->fd, mosi, COMM_SPI_XFER_SIZE) != COMM_SPI_XFER_SIZE ||
+        spi_bench_read_full(m->fd, miso, COMM_SPI_XFER_SIZE) != 0) {
+        return -1;
+    }
+    m->xfers++;
+
+    for (size_t i = 0; i < COMM_SPI_XFER_SIZE; i++) {
+        if (miso[i] == COBS_FRAME_TERM) {
+            if (m->in_frame) {
+                m->frames_in++;
+            }
+            m->in_frame = false;
+        } else {
+            m->in_frame = true;
+        }
+    }
+    return 0;
+}
+
+// Append a CONTROL SET_ACK_MODE(EACH) request with payload_len bytes of payload
+static void spi_bench_queue_request(spi_bench_master_t *m, uint8_t seq, size_t payload_len) {
+    uint8_t raw[8 + SPI_BENCH_STREAM_PAYLOAD];
+    uint8_t *p = raw;
+    *p++ = 0x94;
+    *p++ = FMRB_LINK_TYPE_CONTROL;
+    *p++ = 0xcc;
+    *p++ = seq;
+    *p++ = FMRB_LINK_CONTROL_SET_ACK_MODE;
+    *p++ = 0xc5;
+    *p++ = (uint8_t)(payload_len >> 8);
+    *p++ = (uint8_t)payload_len;
+    memset(p, 0, payload_len);  // mode = EACH, rest ignored
+    p += payload_len;
+    m->out_len += fmrb_link_cobs_encode_crc(raw, p - raw, m->out + m->out_len);
+}
+
+static void *spi_bench_thread(void *arg) {
+    (void)arg;
+
+    spi_bench_master_t m;
+    memset(&m, 0, sizeof(m));
+    size_t out_cap = SPI_BENCH_STREAM_FRAMES * COBS_ENC_MAX(8 + SPI_BENCH_STREAM_PAYLOAD + FMRB_LINK_CRC_SIZE);
+    m.out = (uint8_t*)malloc(out_cap);
+    int64_t *samples = (int64_t*)malloc(SPI_BENCH_LATENCY_ITERATIONS * sizeof(int64_t));
+
+    m.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, COMM_SPI_SIM_PATH, sizeof(addr.sun_path) - 1);
+
+    int connected = -1;
+    for (int retry = 0; retry < 100 && connected != 0 && m.fd != -1; retry++) {
+        connected = connect(m.fd, (struct sockaddr*)&addr, sizeof(addr));
+        if (connected != 0) {
+            usleep(10000);
+        }
+    }
+    if (connected != 0 || !m.out || !samples) {
+        printf("SPI bench: failed to connect to %s\n", COMM_SPI_SIM_PATH);
+        goto done;
+    }
+
+    // Latency: one small request, clock transactions until its ACK is on MISO
+    uint32_t xfers_total = 0;
+    for (int i = 0; i < SPI_BENCH_LATENCY_ITERATIONS; i++) {
+        m.out_len = 0;
+        m.out_pos = 0;
+        spi_bench_queue_request(&m, (uint8_t)i, 1);
+        uint32_t expect = m.frames_in + 1;
+        uint32_t xfers_start = m.xfers;
+
+        int64_t start = fmrb_link_bench_now_us();
+        while (m.frames_in < expect) {
+            if (spi_bench_xfer(&m) != 0) {
+                printf("SPI bench: connection lost\n");
+                goto done;
+            }
+        }
+        samples[i] = fmrb_link_bench_now_us() - start;
+        xfers_total += m.xfers - xfers_start;
+    }
+    qsort(samples, SPI_BENCH_LATENCY_ITERATIONS, sizeof(int64_t), compare_i64);
+
+    // Throughput: a stream of 1 KB requests packed back to back across transactions
+    m.out_len = 0;
+    m.out_pos = 0;
+    for (int i = 0; i < SPI_BENCH_STREAM_FRAMES; i++) {
+        spi_bench_queue_request(&m, (uint8_t)i, SPI_BENCH_STREAM_PAYLOAD);
+    }
+    uint32_t expect = m.frames_in + SPI_BENCH_STREAM_FRAMES;
+    uint32_t xfers_start = m.xfers;
+    int64_t start = fmrb_link_bench_now_us();
+    while (m.frames_in < expect) {
+        if (spi_bench_xfer(&m) != 0) {
+            printf("SPI bench: connection lost\n");
+            goto done;
+        }
+    }
+    int64_t elapsed = fmrb_link_bench_now_us() - start;
+    uint32_t stream_xfers = m.xfers - xfers_start;
+
+    double wire_mbps = (double)COMM_SPI_SIM_CLOCK_HZ / 8.0 / 1e6;
+    double payload_mbps = (double)SPI_BENCH_STREAM_FRAMES * SPI_BENCH_STREAM_PAYLOAD / (double)elapsed;
+    printf("=== Simulated SPI benchmark (xfer=%d bytes, queue=%d, sclk=%d Hz) ===\n",
+           COMM_SPI_XFER_SIZE, COMM_SPI_QUEUE_DEPTH, COMM_SPI_SIM_CLOCK_HZ);
+    printf("ACK latency p50: %lld us, p99: %lld us (%.1f transactions/request)\n",
+           (long long)samples[SPI_BENCH_LATENCY_ITERATIONS / 2],
+           (long long)samples[SPI_BENCH_LATENCY_ITERATIONS * 99 / 100],
+           (double)xfers_total / SPI_BENCH_LATENCY_ITERATIONS);
+    printf("Stream: %d x %d bytes in %u transactions, %.2f MB/s payload (bus %.2f MB/s, %.0f%%)\n",
+           SPI_BENCH_STREAM_FRAMES, SPI_BENCH_STREAM_PAYLOAD, (unsigned)stream_xfers,
+           payload_mbps, wire_mbps, payload_mbps / wire_mbps * 100.0);
+    printf("=== End simulated SPI benchmark ===\n");
+
+done:
+    if (m.fd != -1) {
+        close(m.fd);
+    }
+    free(m.out);
+    free(samples);
+    return NULL;
+}
+
+static void bench_start_thread(void *(*fn)(void *), const char *name) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, fn, NULL) != 0) {
+        printf("%s: failed to start client thread\n", name);
+        return;
+    }
+    pthread_detach(thread);
+}
+
+void fmrb_link_bench_ack_latency_start(void) {
+    bench_start_thread(ack_bench_thread, "ACK bench");
+}
+
+void fmrb_link_bench_spi_sim_start(void) {
+    bench_start_thread(spi_bench_thread, "SPI bench");
+}
+#else
+void fmrb_link_bench_ack_latency_start(void) {
+    printf("ACK bench: only available with the Linux socket server\n");
+}
+
+void fmrb_link_bench_spi_sim_start(void) {
+    printf("SPI bench: only available with the Linux SPI simulator\n");
+}
+#endif
@@ -0,0 +1,62 @@
+#ifndef FMRB_LINK_BENCH_H
+#define FMRB_LINK_BENCH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Link layer microbenchmarks
+ * Results are printed to stdout. They run at startup when selected with the
+ * FMRB_BENCH environment variable (Linux) or CONFIG_FMRB_BENCH (menuconfig),
+ * e.g. FMRB_BENCH=crc32,cobs_crc.
+ */
+
+#include <stdbool.h>
+
+/**
+ * @brief Check whether a benchmark was selected at startup
+ * @param name Benchmark name (e.g. "crc32")
+ * @return true if FMRB_BENCH / CONFIG_FMRB_BENCH lists the name or "all"
+ */
+bool fmrb_link_bench_enabled(const char *name);
+
+/**
+ * @brief Get a monotonic timestamp for benchmarks
+ * @return Time in microseconds
+ */
+int64_t fmrb_link_bench_now_us(void);
+
+/**
+ * @brief CRC32 throughput (GB/s) across payload sizes, current engine vs bytewise table
+ */
+void fmrb_link_bench_crc32(void);
+
+/**
+ * @brief COBS decode + CRC32 verify throughput on a bitmap-sized frame, two-pass vs fused
+ */
+void fmrb_link_bench_cobs_crc(void);
+
+/**
+ * @brief Request/ACK round-trip latency (p50/p99) against the local socket server
+ *
+ * Starts a client thread and returns immediately; the server must be running
+ * its normal loop and no other client may be connected. Linux only.
+ */
+void fmrb_link_bench_ack_latency_start(void);
+
+/**
+ * @brief Simulated SPI link: ACK latency (p50/p99) and streaming throughput
+ *
+ * Starts a simulated master thread that clocks fixed-size transactions against
+ * the SPI simulator (FMRB_COMM=spi_sim) and returns immediately. Linux only.
+ */
+void fmrb_link_bench_spi_sim_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMRB_LINK_BENCH_H
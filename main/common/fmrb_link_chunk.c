@@ -0,0 +1,157 @@
+#include "fmrb_link_chunk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Chunks that still fit in the reassembly buffer beyond next_offset
+static uint16_t chunk_credit(const fmrb_link_chunk_lane_t *lane) {
+    uint32_t free_bytes = lane->total_len - lane->next_offset;
+    uint32_t unit = lane->chunk_size ? lane->chunk_size : 1;
+    uint32_t chunks = (free_bytes + unit - 1) / unit;
+    return (uint16_t)(chunks < FMRB_LINK_CHUNK_WINDOW ? chunks : FMRB_LINK_CHUNK_WINDOW);
+}
+
+static void chunk_fill_ack(const fmrb_link_chunk_lane_t *lane, uint8_t chunk_id,
+                           uint16_t credit, fmrb_link_frame_chunk_ack_t *ack) {
+    ack->chunk_id = chunk_id;
+    ack->gen = lane->gen;
+    ack->credit = credit;
+    ack->next_offset = lane->next_offset;
+}
+
+static int chunk_lane_start(fmrb_link_chunk_rx_t *rx, fmrb_link_chunk_lane_t *lane,
+                            uint8_t sub_cmd, uint32_t total_len) {
+    if (total_len == 0 || total_len > FMRB_LINK_CHUNK_MAX_TOTAL) {
+        fprintf(stderr, "Chunk: invalid total_len=%u\n", (unsigned)total_len);
+        return -1;
+    }
+
+    // Reuse the previous destination when large enough
+    if (lane->cap < total_len) {
+        uint8_t *buf = (uint8_t*)realloc(lane->buf, total_len);
+        if (!buf) {
+            fprintf(stderr, "Chunk: failed to allocate %u bytes\n", (unsigned)total_len);
+            return -1;
+        }
+        lane->buf = buf;
+        lane->cap = total_len;
+        rx->allocs++;
+    }
+
+    lane->total_len = total_len;
+    lane->next_offset = 0;
+    lane->unacked = 0;
+    lane->chunk_size = 0;
+    lane->nacked = false;
+    lane->gen++;
+    lane->sub_cmd = sub_cmd;
+    lane->active = true;
+    return 0;
+}
+
+fmrb_link_chunk_result_t fmrb_link_chunk_receive(fmrb_link_chunk_rx_t *rx, uint8_t sub_cmd,
+                                                 const uint8_t *payload, size_t payload_len,
+                                                 fmrb_link_frame_chunk_ack_t *ack,
+                                                 const uint8_t **data, size_t *len) {
+    memset(ack, 0, sizeof(*ack));
+
+    if (payload_len < sizeof(fmrb_link_chunk_info_t)) {
+        fprintf(stderr, "Chunk: frame too small (%zu)\n", payload_len);
+        return FMRB_LINK_CHUNK_ERROR;
+    }
+
+    fmrb_link_chunk_info_t info;
+    memcpy(&info, payload, sizeof(info));
+    const uint8_t *chunk = payload + sizeof(info);
+    size_t chunk_len = payload_len - sizeof(info);
+
+    if (info.chunk_id >= FMRB_LINK_CHUNK_LANES) {
+        fprintf(stderr, "Chunk: invalid lane %u\n", info.chunk_id);
+        ack->chunk_id = info.chunk_id;
+        return FMRB_LINK_CHUNK_ERROR;
+    }
+    fmrb_link_chunk_lane_t *lane = &rx->lanes[info.chunk_id];
+
+    if (info.chunk_len != chunk_len || (info.flags & FMRB_LINK_CHUNK_FL_ERR)) {
+        // Sender aborted or the header disagrees with the frame
+        lane->active = false;
+        chunk_fill_ack(lane, info.chunk_id, 0, ack);
+        return FMRB_LINK_CHUNK_ERROR;
+    }
+
+    if (info.flags & FMRB_LINK_CHUNK_FL_START) {
+        if (info.offset != 0 || chunk_lane_start(rx, lane, sub_cmd, info.total_len) != 0) {
+            lane->active = false;
+            chunk_fill_ack(lane, info.chunk_id, 0, ack);
+            return FMRB_LINK_CHUNK_ERROR;
+        }
+    }
+
+    if (!lane->active || sub_cmd != lane->sub_cmd || info.total_len != lane->total_len) {
+        chunk_fill_ack(lane, info.chunk_id, 0, ack);
+        return FMRB_LINK_CHUNK_ERROR;
+    }
+
+    if (info.offset != lane->next_offset) {
+        // The rest of the window follows a lost chunk: one NACK per gap
+        if (lane->nacked) {
+            return FMRB_LINK_CHUNK_DROPPED;
+        }
+        // Lost or reordered chunk: ask the sender to rewind (go-back-N)
+        lane->unacked = 0;
+        lane->nacked = true;
+        chunk_fill_ack(lane, info.chunk_id, chunk_credit(lane), ack);
+        return FMRB_LINK_CHUNK_ERROR;
+    }
+
+    if (chunk_len > lane->total_len - lane->next_offset) {
+        lane->active = false;
+        chunk_fill_ack(lane, info.chunk_id, 0, ack);
+        return FMRB_LINK_CHUNK_ERROR;
+    }
+
+    memcpy(lane->buf + lane->next_offset, chunk, chunk_len);
+    lane->next_offset += chunk_len;
+    lane->unacked++;
+    lane->nacked = false;
+    if (chunk_len > lane->chunk_size) {
+        lane->chunk_size = (uint16_t)chunk_len;
+    }
+
+    if (info.flags & FMRB_LINK_CHUNK_FL_END) {
+        if (lane->next_offset != lane->total_len) {
+            lane->active = false;
+            chunk_fill_ack(lane, info.chunk_id, 0, ack);
+            return FMRB_LINK_CHUNK_ERROR;
+        }
+        lane->active = false;
+        *data = lane->buf;
+        *len = lane->total_len;
+        return FMRB_LINK_CHUNK_COMPLETE;
+    }
+
+    if (lane->unacked >= FMRB_LINK_CHUNK_ACK_INTERVAL) {
+        lane->unacked = 0;
+        chunk_fill_ack(lane, info.chunk_id, chunk_credit(lane), ack);
+        return FMRB_LINK_CHUNK_SEND_ACK;
+    }
+
+    return FMRB_LINK_CHUNK_PENDING;
+}
+
+void fmrb_link_chunk_reset(fmrb_link_chunk_rx_t *rx) {
+    for (int i = 0; i < FMRB_LINK_CHUNK_LANES; i++) {
+        rx->lanes[i].active = false;
+        rx->lanes[i].unacked = 0;
+        rx->lanes[i].nacked = false;
+    }
+}
+
+void fmrb_link_chunk_free(fmrb_link_chunk_rx_t *rx) {
+    for (int i = 0; i < FMRB_LINK_CHUNK_LANES; i++) {
+        free(rx->lanes[i].buf);
+        rx->lanes[i].buf = NULL;
+        rx->lanes[i].cap = 0;
+        rx->lanes[i].active = false;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef FMRB_LINK_CHUNK_H
+#define FMRB_LINK_CHUNK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "fmrb_link_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Chunked transfer reassembly (receiver side)
+ *
+ * A message flagged with FMRB_LINK_FLAG_CHUNKED carries a fmrb_link_chunk_info_t
+ * header followed by chunk_len bytes of data. chunk_id selects a lane; each lane
+ * reassembles one message at a time into a buffer sized from total_len at START.
+ *
+ * Flow control is credit based: the sender may have up to `credit` chunks in
+ * flight beyond `next_offset`. The credit is the free space left in the
+ * reassembly buffer, in chunks of the size received so far, capped at
+ * FMRB_LINK_CHUNK_WINDOW. The receiver returns a fmrb_link_frame_chunk_ack_t
+ * every FMRB_LINK_CHUNK_ACK_INTERVAL chunks instead of once per frame, and one
+ * NACK carrying the expected offset per gap: further out-of-order chunks are
+ * dropped silently until the expected one arrives.
+ * Completion of the whole message is acknowledged by the handler of the
+ * reassembled command, as for a non-chunked message.
+ */
+
+#define FMRB_LINK_CHUNK_LANES         4
+#define FMRB_LINK_CHUNK_WINDOW        8
+#define FMRB_LINK_CHUNK_ACK_INTERVAL  (FMRB_LINK_CHUNK_WINDOW / 2)
+#define FMRB_LINK_CHUNK_MAX_TOTAL     (512 * 1024)
+
+typedef enum {
+    FMRB_LINK_CHUNK_ERROR = -1,     // Chunk rejected, send NACK with ack
+    FMRB_LINK_CHUNK_PENDING = 0,    // Chunk accepted, no response needed
+    FMRB_LINK_CHUNK_SEND_ACK = 1,   // Chunk accepted, send credit ACK with ack
+    FMRB_LINK_CHUNK_COMPLETE = 2,   // Message complete, dispatch *data / *len
+    FMRB_LINK_CHUNK_DROPPED = 3     // Out of order after a NACK for the same gap, no response
+} fmrb_link_chunk_result_t;
+
+typedef struct {
+    uint8_t *buf;          // Reassembly destination (kept across transfers)
+    size_t cap;            // Allocated size of buf
+    uint32_t total_len;    // Expected message length
+    uint32_t next_offset;  // Next in-order offset
+    uint16_t unacked;      // Chunks accepted since last ACK
+    uint16_t chunk_size;   // Largest chunk received (credit unit)
+    bool nacked;           // NACK sent for the gap at next_offset
+    uint8_t gen;           // Generation, bumped on every START
+    uint8_t sub_cmd;       // Sub-command of the message being reassembled
+    bool active;
+} fmrb_link_chunk_lane_t;
+
+typedef struct {
+    fmrb_link_chunk_lane_t lanes[FMRB_LINK_CHUNK_LANES];
+    uint32_t allocs;       // Reassembly buffer (re)allocations
+} fmrb_link_chunk_rx_t;
+
+/**
+ * @brief Feed one chunked frame into the reassembler
+ * @param rx Reassembler state
+ * @param sub_cmd Sub-command of the frame
+ * @param payload Frame payload (chunk header + data)
+ * @param payload_len Payload length
+ * @param ack Filled when the result is SEND_ACK or ERROR
+ * @param data Set to the reassembled message when the result is COMPLETE
+ * @param len Set to the reassembled length when the result is COMPLETE
+ * @return fmrb_link_chunk_result_t
+ */
+fmrb_link_chunk_result_t fmrb_link_chunk_receive(fmrb_link_chunk_rx_t *rx, uint8_t sub_cmd,
+                                                 const uint8_t *payload, size_t payload_len,
+                                                 fmrb_link_frame_chunk_ack_t *ack,
+                                                 const uint8_t **data, size_t *len);
+
+/**
+ * @brief Abort all in-progress transfers (e.g. on disconnect), keeping buffers
+ * @param rx Reassembler state
+ */
+void fmrb_link_chunk_reset(fmrb_link_chunk_rx_t *rx);
+
+/**
+ * @brief Release reassembly buffers
+ * @param rx Reassembler state
+ */
+void fmrb_link_chunk_free(fmrb_link_chunk_rx_t *rx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMRB_LINK_CHUNK_H
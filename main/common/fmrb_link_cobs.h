@@ -16,6 +16,9 @@ extern "C" {
 
 #define COBS_FRAME_TERM 0x00
 
+// CRC32 trailer size appended to every link frame
+#define FMRB_LINK_CRC_SIZE 4
+
 /**
  * @brief Calculate maximum encoded size for given input size
  * @param input_len Input data length
@@ -41,6 +44,47 @@ size_t fmrb_link_cobs_encode(const uint8_t *input, size_t input_len, uint8_t *ou
  */
 ssize_t fmrb_link_cobs_decode(const uint8_t *input, size_t input_len, uint8_t *output);
 
+/**
+ * @brief Encode data plus its CRC32 trailer using COBS in a single pass
+ *
+ * Equivalent to fmrb_link_cobs_encode() over (input || crc32(input)), with the
+ * CRC computed while encoding.
+ *
+ * @param input Input data (without CRC)
+ * @param input_len Input data length
+ * @param output Output buffer (must be at least COBS_ENC_MAX(input_len + FMRB_LINK_CRC_SIZE) bytes)
+ * @return Encoded data length (including 0x00 terminator)
+ */
+size_t fmrb_link_cobs_encode_crc(const uint8_t *input, size_t input_len, uint8_t *output);
+
+/**
+ * @brief Decode COBS data and compute the CRC32 of the payload in a single pass
+ *
+ * The decoded frame is payload followed by a FMRB_LINK_CRC_SIZE-byte CRC32 trailer.
+ * The CRC is updated block by block as the data is decoded, so the caller only
+ * compares *crc_out with the trailer. output may equal input (in-place decode).
+ *
+ * @param input Encoded data (without 0x00 terminator)
+ * @param input_len Encoded data length
+ * @param output Output buffer (must be at least input_len bytes)
+ * @param crc_out CRC32 of the decoded payload (trailer excluded)
+ * @return Decoded data length including the trailer, or -1 on error
+ */
+ssize_t fmrb_link_cobs_decode_crc(const uint8_t *input, size_t input_len, uint8_t *output, uint32_t *crc_out);
+
+/**
+ * CRC32 implementation selection (build time)
+ * 1: slicing-by-8 (8 KB of tables, ~3-5x faster), 0: byte-at-a-time table.
+ * Slicing-by-8 assumes a little-endian target (ESP32 and x86 Linux host).
+ */
+#ifndef FMRB_LINK_CRC32_SLICE8
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define FMRB_LINK_CRC32_SLICE8 1
+#else
+#define FMRB_LINK_CRC32_SLICE8 0
+#endif
+#endif
+
 /**
  * @brief Calculate CRC32 checksum
  * @param crc Initial CRC value (use 0 for new calculation)
@@ -50,6 +94,15 @@ ssize_t fmrb_link_cobs_decode(const uint8_t *input, size_t input_len, uint8_t *o
  */
 uint32_t fmrb_link_crc32_update(uint32_t crc, const uint8_t *data, size_t len);
 
+/**
+ * @brief Reference byte-at-a-time CRC32 (same result as fmrb_link_crc32_update)
+ * @param crc Initial CRC value (use 0 for new calculation)
+ * @param data Data to checksum
+ * @param len Data length
+ * @return CRC32 checksum
+ */
+uint32_t fmrb_link_crc32_update_bytewise(uint32_t crc, const uint8_t *data, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,7 @@ typedef enum {
 //---------------------------
 #define FMRB_LINK_CONTROL_VERSION      0x01
 #define FMRB_LINK_CONTROL_INIT_DISPLAY 0x02
+#define FMRB_LINK_CONTROL_SET_ACK_MODE 0x03
 
 // Control command structures
 typedef struct __attribute__((packed)) {
@@ -40,15 +41,45 @@ typedef struct __attribute__((packed)) {
     uint8_t version;  // Protocol version number
 } fmrb_control_version_resp_t;
 
+// Optional feature negotiation: a VERSION request may append a feature mask;
+// the response then carries the subset the host accepted. Old clients that
+// send only the version byte get the 1-byte response and no features.
+#define FMRB_LINK_FEATURE_BINARY_HDR   0x01  // Binary frame header instead of msgpack envelope
+#define FMRB_LINK_FEATURES_SUPPORTED   (FMRB_LINK_FEATURE_BINARY_HDR)
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;   // Protocol version number
+    uint8_t features;  // FMRB_LINK_FEATURE_* mask (requested / accepted)
+} fmrb_control_version_ext_t;
+
 typedef struct __attribute__((packed)) {
     uint16_t width;
     uint16_t height;
     uint8_t color_depth;     // 8 for RGB332
 } fmrb_control_init_display_t;
 
+// ACK modes (FMRB_LINK_CONTROL_SET_ACK_MODE)
+#define FMRB_LINK_ACK_MODE_EACH        0  // One ACK per message (default)
+#define FMRB_LINK_ACK_MODE_CUMULATIVE  1  // Plain ACKs may be folded into ACK_CUMULATIVE
+
+typedef struct __attribute__((packed)) {
+    uint8_t mode;  // FMRB_LINK_ACK_MODE_*
+} fmrb_control_ack_mode_t;
+
 // Protocol response codes
+//
+// Graphics commands are queued and applied by the graphics task at the next
+// frame boundary, so their ACK means "accepted", not "drawn":
+// - Framing, BATCH records and canvas ID availability are checked before the
+//   ACK; a command that fails them is not acknowledged.
+// - A command arriving while the queue is full is not acknowledged either and
+//   must be retransmitted (backpressure; the link never blocks on the queue).
+// - Failures when the command is applied (e.g. out of memory creating a canvas
+//   whose ID was already returned) are only logged; later commands on that
+//   canvas fail the same way.
 #define FMRB_LINK_RESPONSE_MSG_ACK     0xF0
 #define FMRB_LINK_RESPONSE_MSG_NACK    0xF1
+#define FMRB_LINK_RESPONSE_MSG_ACK_CUMULATIVE 0xF2  // All messages of this type up to seq succeeded
 
 // Graphics sub-commands (LovyanGFX API in snake_case)
 typedef enum {
@@ -92,6 +123,12 @@ typedef enum {
     FMRB_LINK_GFX_SET_TEXT_SIZE = 0x22,
     FMRB_LINK_GFX_SET_TEXT_COLOR = 0x23,
 
+    // Bulk drawing (count + packed array, one envelope/ACK for many primitives)
+    FMRB_LINK_GFX_DRAW_PIXELS = 0x28,
+    FMRB_LINK_GFX_DRAW_POLYLINE = 0x29,
+    FMRB_LINK_GFX_DRAW_LINES = 0x2A,
+    FMRB_LINK_GFX_FILL_RECTS = 0x2B,
+
     // Clear and fill
     FMRB_LINK_GFX_CLEAR = 0x30,
     FMRB_LINK_GFX_FILL_SCREEN = 0x31,
@@ -107,9 +144,26 @@ typedef enum {
     FMRB_LINK_GFX_SET_TARGET = 0x52,
     FMRB_LINK_GFX_PUSH_CANVAS = 0x53,
 
+    // Tilemap layers (shown by a canvas)
+    FMRB_LINK_GFX_SET_TILEMAP = 0x54,
+    FMRB_LINK_GFX_SET_TILES = 0x55,
+    FMRB_LINK_GFX_SET_SCROLL = 0x56,
+
     // Cursor control (global resource, no canvas_id)
     FMRB_LINK_GFX_CURSOR_SET_POSITION = 0x60,
-    FMRB_LINK_GFX_CURSOR_SET_VISIBLE = 0x61
+    FMRB_LINK_GFX_CURSOR_SET_VISIBLE = 0x61,
+
+    // Sprite table (global resource, no canvas_id)
+    FMRB_LINK_GFX_SET_SPRITES = 0x62,
+    FMRB_LINK_GFX_SPRITE_CONFIG = 0x63,
+
+    // Batched commands (one envelope / one ACK for many sub-commands)
+    FMRB_LINK_GFX_BATCH = 0x70,
+
+    // Display lists (recorded on the graphics side, replayed by ID)
+    FMRB_LINK_GFX_BEGIN_LIST = 0x71,
+    FMRB_LINK_GFX_END_LIST = 0x72,
+    FMRB_LINK_GFX_CALL_LIST = 0x73
 } fmrb_link_graphics_cmd_t;
 
 // Audio sub-commands
@@ -129,6 +183,15 @@ typedef struct __attribute__((packed)) {
     uint16_t len;    // Payload bytes
 } fmrb_link_frame_hdr_t;
 
+// Binary fast-path frame (FMRB_LINK_FEATURE_BINARY_HDR), before COBS:
+//   FMRB_LINK_FRAME_BINARY | fmrb_link_frame_hdr_t | sub_cmd (1 byte) | payload (hdr.len bytes) | CRC32
+// The first byte tells the formats apart: the msgpack envelope [type, seq,
+// sub_cmd, payload] (always FMRB_LINK_FRAME_MSGPACK, a fixarray of 4) stays
+// accepted in this mode; frames starting with any other byte are rejected.
+#define FMRB_LINK_FRAME_MSGPACK 0x94
+#define FMRB_LINK_FRAME_BINARY  0xB1
+#define FMRB_LINK_BIN_HDR_SIZE  (1 + sizeof(fmrb_link_frame_hdr_t) + 1)
+
 // Chunk flags
 typedef enum {
     FMRB_LINK_CHUNK_FL_START = 1 << 0,
@@ -232,6 +295,88 @@ typedef struct __attribute__((packed)) {
     uint8_t color;  // RGB332 format
 } fmrb_link_graphics_triangle_t;
 
+// Bulk drawing structures: a header followed by `count` packed items
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;  // Target canvas ID (0=screen)
+    uint16_t count;      // Number of items that follow
+} fmrb_link_graphics_bulk_t;
+
+// DRAW_PIXELS item
+typedef struct __attribute__((packed)) {
+    int16_t x, y;
+    uint8_t color;  // RGB332 format
+} fmrb_link_graphics_pixel_item_t;
+
+// DRAW_POLYLINE: one colour, `count` points joined in order
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;  // Target canvas ID (0=screen)
+    uint16_t count;      // Number of points that follow
+    uint8_t color;       // RGB332 format
+} fmrb_link_graphics_polyline_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t x, y;
+} fmrb_link_graphics_point_item_t;
+
+// DRAW_LINES item
+typedef struct __attribute__((packed)) {
+    int16_t x1, y1;
+    int16_t x2, y2;
+    uint8_t color;  // RGB332 format
+} fmrb_link_graphics_line_item_t;
+
+// FILL_RECTS item
+typedef struct __attribute__((packed)) {
+    int16_t x, y;
+    int16_t width, height;
+    uint8_t color;  // RGB332 format
+} fmrb_link_graphics_rect_item_t;
+
+// Image store structures
+// Images are uploaded once, kept by the graphics side under a client-chosen ID
+// and then drawn by ID. Pixels are stored as RGB332.
+#define FMRB_LINK_IMAGE_FORMAT_RGB332   0  // Raw pixels, width * height bytes, row-major
+#define FMRB_LINK_IMAGE_FORMAT_ENCODED  1  // BMP, PNG or JPEG data, decoded into width x height
+
+typedef struct __attribute__((packed)) {
+    uint16_t image_id;       // Non-zero; an existing image with the same ID is replaced
+    uint16_t width, height;
+    uint8_t format;          // FMRB_LINK_IMAGE_FORMAT_*
+    uint32_t data_len;
+    // Followed by image data
+} fmrb_link_graphics_create_image_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t image_id;       // Non-zero; an existing image with the same ID is replaced
+    uint16_t width, height;  // BMP/PNG/JPEG files are decoded into this size; other files must be raw RGB332 of this size
+    uint16_t path_len;
+    // Followed by the file path (no terminating NUL)
+} fmrb_link_graphics_create_image_file_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t image_id;
+} fmrb_link_graphics_delete_image_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;        // Target canvas ID (0=screen)
+    uint16_t image_id;
+    int16_t x, y;
+    uint8_t transparent_color;
+    uint8_t use_transparency;  // 0=no, 1=yes
+    // Source rectangle (optional, may be omitted: whole image)
+    uint16_t src_x, src_y;
+    uint16_t src_w, src_h;     // 0 = up to the image edge
+} fmrb_link_graphics_draw_image_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;        // Target canvas ID (0=screen)
+    int16_t x, y;
+    uint16_t width, height;
+    uint8_t transparent_color;
+    uint8_t use_transparency;  // 0=no, 1=yes
+    // Followed by width * height RGB332 pixels
+} fmrb_link_graphics_draw_bitmap_t;
+
 // Canvas management structures
 typedef struct __attribute__((packed)) {
     uint16_t canvas_id;
@@ -266,6 +411,65 @@ typedef struct __attribute__((packed)) {
     uint8_t use_transparency;  // 0=no, 1=yes
 } fmrb_link_graphics_push_canvas_t;
 
+// Tilemap structures
+// A canvas with a tilemap shows the tilemap instead of its own pixels: the
+// compositor renders the visible part straight from the tile sheet (an image
+// in the image store), wrapping around the map, so scrolling a background is
+// one SET_SCROLL per frame. Tiles are numbered left to right, top to bottom
+// across the sheet; indices outside the sheet (e.g. FMRB_LINK_TILE_EMPTY) are black.
+// The canvas is shown once it is visible (first present), as without a tilemap.
+// The map may be at most 65536 pixels wide and high (map_w * tile_w, map_h * tile_h).
+#define FMRB_LINK_TILE_EMPTY 0xFFFF
+
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;
+    uint16_t image_id;       // Tile sheet (0 = remove the tilemap)
+    uint8_t tile_w, tile_h;  // Tile size in pixels
+    uint16_t map_w, map_h;   // Map size in tiles (all cells start as tile 0)
+} fmrb_link_graphics_set_tilemap_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;
+    uint16_t x, y;           // First map cell
+    uint16_t width, height;  // Cells to set
+    // Followed by width * height uint16_t tile indices, row-major
+} fmrb_link_graphics_set_tiles_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;
+    int32_t scroll_x, scroll_y;  // Map pixel shown at the canvas top-left
+} fmrb_link_graphics_set_scroll_t;
+
+// Sprite table structures
+// The graphics side keeps FMRB_LINK_SPRITE_COUNT sprites, each showing an image
+// from the image store at a screen position. They are drawn over all canvases
+// (below the cursor) by priority: higher priorities on top, and the lower index
+// on top among equal priorities. SET_SPRITES updates any number of entries, so
+// moving every sprite is one command per frame.
+#define FMRB_LINK_SPRITE_COUNT 128
+
+#define FMRB_LINK_SPRITE_VISIBLE 0x01
+#define FMRB_LINK_SPRITE_HFLIP   0x02
+#define FMRB_LINK_SPRITE_VFLIP   0x04
+#define FMRB_LINK_SPRITE_OPAQUE  0x08  // Draw the transparent colour too
+
+typedef struct __attribute__((packed)) {
+    uint16_t count;  // Number of items that follow
+} fmrb_link_graphics_set_sprites_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t index;      // Sprite table entry (0 to FMRB_LINK_SPRITE_COUNT - 1)
+    uint16_t image_id;  // 0 = hidden
+    int16_t x, y;       // Screen position of the image top-left
+    uint8_t flags;      // FMRB_LINK_SPRITE_*
+    uint8_t priority;
+} fmrb_link_graphics_sprite_item_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t transparent_color;  // RGB332 (default magenta, 0xE3)
+    uint8_t line_limit;         // Sprites shown per scanline, topmost first (0 = unlimited, the default)
+} fmrb_link_graphics_sprite_config_t;
+
 // Cursor control structures (no canvas_id - cursor is global)
 typedef struct __attribute__((packed)) {
     int32_t x, y;
@@ -276,10 +480,50 @@ typedef struct __attribute__((packed)) {
 } fmrb_link_graphics_cursor_visible_t;
 
 // Present command structure
+// PRESENT swaps the canvas draw and render buffers instead of copying. Afterwards
+// the draw buffer holds the previously presented frame, unless
+// FMRB_LINK_PRESENT_PRESERVE is set: then the area drawn since the last present
+// is copied back so drawing can continue on the presented contents.
+#define FMRB_LINK_PRESENT_PRESERVE 0x01
+
 typedef struct __attribute__((packed)) {
     uint16_t canvas_id;  // Canvas to present (0=screen/back_buffer, other=canvas ID)
+    uint8_t flags;       // FMRB_LINK_PRESENT_* (may be omitted by older clients: 0)
 } fmrb_link_graphics_present_t;
 
+// Batch command: payload is a sequence of records, each an item header
+// followed by `len` bytes of the sub-command structure (e.g. fmrb_link_graphics_rect_t)
+typedef struct __attribute__((packed)) {
+    uint16_t count;  // Number of records that follow
+} fmrb_link_graphics_batch_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t cmd_type;  // Graphics sub-command (BATCH cannot be nested)
+    uint16_t len;      // Structure length
+    // Followed by structure data
+} fmrb_link_graphics_batch_item_t;
+
+// Display list structures
+// Drawing commands between BEGIN_LIST and END_LIST are recorded instead of
+// drawn (a BATCH is recorded as its sub-commands). CALL_LIST replays them from
+// the recorded structures, moved by (dx, dy) and drawn to its canvas; the
+// recorded canvas IDs are ignored. A list may call other lists (8 levels deep,
+// not recursively, at most 65536 records replayed per CALL_LIST). Commands that
+// cannot be replayed (canvas, image, sprite and cursor management, PRESENT)
+// are applied immediately while recording. BEGIN_LIST of an existing ID
+// replaces that list when END_LIST is received; an empty list deletes it.
+// A recorded command shorter than its structure fails END_LIST (the list is
+// discarded); a CALL_LIST with failing commands still runs the others.
+typedef struct __attribute__((packed)) {
+    uint16_t list_id;  // Non-zero
+} fmrb_link_graphics_list_t;  // BEGIN_LIST and END_LIST
+
+typedef struct __attribute__((packed)) {
+    uint16_t canvas_id;  // Target canvas ID (0=screen)
+    uint16_t list_id;
+    int16_t dx, dy;      // Offset added to every recorded coordinate
+} fmrb_link_graphics_call_list_t;
+
 // Audio message structures
 typedef struct __attribute__((packed)) {
     uint32_t sample_rate;
@@ -0,0 +1,113 @@
+#include "fmrb_spsc_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Each record is a uint32_t length followed by the data, padded to 4 bytes.
+// A length of RING_WRAP means "skip to the start of the buffer".
+#define RING_HDR_SIZE  4
+#define RING_WRAP      0xFFFFFFFFu
+#define RING_ALIGN(n)  (((n) + 3u) & ~3u)
+
+static inline uint32_t ring_load_acquire(const uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void ring_store_release(uint32_t *p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+int fmrb_spsc_ring_init(fmrb_spsc_ring_t *ring, uint32_t size) {
+    uint32_t cap = 64;
+    while (cap < size) {
+        cap <<= 1;
+    }
+
+    ring->buf = (uint8_t*)malloc(cap);
+    if (!ring->buf) {
+        fprintf(stderr, "SPSC ring: failed to allocate %u bytes\n", (unsigned)cap);
+        return -1;
+    }
+    ring->size = cap;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->reserved = 0;
+    return 0;
+}
+
+void fmrb_spsc_ring_free(fmrb_spsc_ring_t *ring) {
+    free(ring->buf);
+    ring->buf = NULL;
+    ring->size = 0;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->reserved = 0;
+}
+
+void *fmrb_spsc_ring_reserve(fmrb_spsc_ring_t *ring, uint32_t len) {
+    uint32_t need = RING_HDR_SIZE + RING_ALIGN(len);
+    if (!ring->buf || need >= ring->size) {
+        return NULL;
+    }
+
+    uint32_t head = ring_load_acquire(&ring->head);
+    uint32_t free_bytes = ring->size - (ring->tail - head);
+    uint32_t off = ring->tail & (ring->size - 1);
+    uint32_t contig = ring->size - off;
+
+    if (need <= contig) {
+        if (need > free_bytes) {
+            return NULL;
+        }
+        memcpy(ring->buf + off, &len, sizeof(len));
+        ring->reserved = need;
+        return ring->buf + off + RING_HDR_SIZE;
+    }
+
+    // Not enough room before the end: mark the rest as padding and start over
+    if (contig + need > free_bytes) {
+        return NULL;
+    }
+    uint32_t wrap = RING_WRAP;
+    memcpy(ring->buf + off, &wrap, sizeof(wrap));
+    memcpy(ring->buf, &len, sizeof(len));
+    ring->reserved = contig + need;
+    return ring->buf + RING_HDR_SIZE;
+}
+
+void fmrb_spsc_ring_commit(fmrb_spsc_ring_t *ring) {
+    ring_store_release(&ring->tail, ring->tail + ring->reserved);
+    ring->reserved = 0;
+}
+
+uint32_t fmrb_spsc_ring_snapshot(const fmrb_spsc_ring_t *ring) {
+    return ring_load_acquire(&ring->tail);
+}
+
+const void *fmrb_spsc_ring_peek(fmrb_spsc_ring_t *ring, uint32_t limit, uint32_t *len) {
+    uint32_t head = ring->head;
+    if (head == limit) {
+        return NULL;
+    }
+
+    uint32_t off = head & (ring->size - 1);
+    uint32_t hdr;
+    memcpy(&hdr, ring->buf + off, sizeof(hdr));
+    if (hdr == RING_WRAP) {
+        // Padding is always committed together with the record that follows it
+        head += ring->size - off;
+        ring_store_release(&ring->head, head);
+        off = 0;
+        memcpy(&hdr, ring->buf, sizeof(hdr));
+    }
+
+    *len = hdr;
+    return ring->buf + off + RING_HDR_SIZE;
+}
+
+void fmrb_spsc_ring_release(fmrb_spsc_ring_t *ring) {
+    uint32_t off = ring->head & (ring->size - 1);
+    uint32_t hdr;
+    memcpy(&hdr, ring->buf + off, sizeof(hdr));
+    ring_store_release(&ring->head, ring->head + RING_HDR_SIZE + RING_ALIGN(hdr));
+}
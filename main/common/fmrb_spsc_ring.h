@@ -0,0 +1,89 @@
+#ifndef FMRB_SPSC_RING_H
+#define FMRB_SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bounded single-producer/single-consumer ring of variable-length records
+ *
+ * Lock-free: the producer only writes `tail`, the consumer only writes `head`,
+ * and each side publishes with a release store that the other side reads with
+ * an acquire load. Records are contiguous (a record that would straddle the
+ * end of the buffer is preceded by a wrap marker) and 4-byte aligned, so a
+ * record can be cast to a struct in place.
+ *
+ * Producer: reserve() -> fill -> commit()
+ * Consumer: peek() -> use -> release()
+ */
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;       // Buffer size (power of two)
+    uint32_t head;       // Consumer position (free running, written by consumer)
+    uint32_t tail;       // Producer position (free running, written by producer)
+    uint32_t reserved;   // Producer: bytes reserved by the last reserve()
+} fmrb_spsc_ring_t;
+
+/**
+ * @brief Allocate the ring buffer
+ * @param ring Ring
+ * @param size Buffer size in bytes (rounded up to a power of two)
+ * @return 0 on success, -1 on error
+ */
+int fmrb_spsc_ring_init(fmrb_spsc_ring_t *ring, uint32_t size);
+
+/**
+ * @brief Release the ring buffer (no producer or consumer may be active)
+ * @param ring Ring
+ */
+void fmrb_spsc_ring_free(fmrb_spsc_ring_t *ring);
+
+/**
+ * @brief Producer: reserve contiguous space for one record
+ * @param ring Ring
+ * @param len Record length in bytes
+ * @return Pointer to fill, or NULL if the ring is currently too full
+ */
+void *fmrb_spsc_ring_reserve(fmrb_spsc_ring_t *ring, uint32_t len);
+
+/**
+ * @brief Producer: publish the record filled after fmrb_spsc_ring_reserve()
+ * @param ring Ring
+ */
+void fmrb_spsc_ring_commit(fmrb_spsc_ring_t *ring);
+
+/**
+ * @brief Consumer: snapshot of the producer position
+ *
+ * Passing the snapshot to fmrb_spsc_ring_peek() bounds a drain to the records
+ * that were already published, even if the producer keeps adding more.
+ * @param ring Ring
+ * @return Producer position
+ */
+uint32_t fmrb_spsc_ring_snapshot(const fmrb_spsc_ring_t *ring);
+
+/**
+ * @brief Consumer: get the oldest record published before `limit`
+ * @param ring Ring
+ * @param limit Position from fmrb_spsc_ring_snapshot()
+ * @param len Set to the record length
+ * @return Pointer to the record, or NULL if none
+ */
+const void *fmrb_spsc_ring_peek(fmrb_spsc_ring_t *ring, uint32_t limit, uint32_t *len);
+
+/**
+ * @brief Consumer: drop the record returned by fmrb_spsc_ring_peek()
+ * @param ring Ring
+ */
+void fmrb_spsc_ring_release(fmrb_spsc_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMRB_SPSC_RING_H
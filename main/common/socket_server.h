@@ -3,11 +3,17 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "comm_link.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define SOCKET_SERVER_PATH "/tmp/fmrb_socket"
+
+// Link statistics (the socket server is a transport for the comm_link layer)
+typedef comm_link_stats_t socket_server_stats_t;
+
 /**
  * @brief Start socket server
  * @return 0 on success, -1 on error
@@ -25,6 +31,18 @@ void socket_server_stop(void);
  */
 int socket_server_process(void);
 
+/**
+ * @brief Block until a client connects, data arrives or socket_server_wakeup() is called
+ * @param timeout_ms Maximum time to wait in milliseconds (-1 waits forever)
+ * @return 1 if socket_server_process() has work, 0 on timeout or wake-up, -1 on error
+ */
+int socket_server_wait(int timeout_ms);
+
+/**
+ * @brief Interrupt a pending socket_server_wait() (async-signal-safe)
+ */
+void socket_server_wakeup(void);
+
 /**
  * @brief Check if server is running
  * @return 1 if running, 0 if not
@@ -41,6 +59,12 @@ int socket_server_is_running(void);
  */
 int socket_server_send_ack(uint8_t type, uint8_t seq, const uint8_t *response_data, uint16_t response_len);
 
+/**
+ * @brief Get link statistics
+ * @param stats Output statistics
+ */
+void socket_server_get_stats(socket_server_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,20 @@ typedef struct {
      */
     int (*process)(void);
 
+    /**
+     * Block until there is work for process() (optional, may be NULL)
+     * Returns early when wakeup() is called
+     * @param timeout_ms Maximum time to wait in milliseconds
+     * @return 1 if process() should run, 0 on timeout or wake-up, -1 on error
+     */
+    int (*wait)(int timeout_ms);
+
+    /**
+     * Interrupt a pending wait() (optional, may be NULL)
+     * Async-signal-safe, so it can be called from a signal handler
+     */
+    void (*wakeup)(void);
+
     /**
      * Send ACK response
      * @param type Message type
@@ -68,6 +82,9 @@ typedef struct {
 #ifdef CONFIG_IDF_TARGET_LINUX
 extern const comm_interface_t* comm_get_interface(void);
 #define COMM_INTERFACE (comm_get_interface())
+
+// Simulated SPI slave (selected with FMRB_COMM=spi_sim)
+extern const comm_interface_t* comm_spi_sim_get_interface(void);
 #else
 extern const comm_interface_t* comm_get_interface(void);
 #define COMM_INTERFACE (comm_get_interface())
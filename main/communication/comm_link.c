@@ -0,0 +1,772 @@
+#include "comm_link.h"
+#include "graphics_handler.h"
+#include "audio_handler.h"
+#include "fmrb_link_cobs.h"
+#include "fmrb_link_chunk.h"
+#include "fmrb_link_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+// Link log levels
+typedef enum {
+    LINK_LOG_NONE = 0,     // No logging
+    LINK_LOG_ERROR = 1,    // Error messages only
+    LINK_LOG_INFO = 2,     // Info + Error
+    LINK_LOG_DEBUG = 3,    // Debug + Info + Error (verbose)
+} link_log_level_t;
+
+// Current log level (default: errors only)
+static link_log_level_t g_link_log_level = LINK_LOG_ERROR;
+
+// Log macros
+#define LINK_LOG_E(fmt, ...) do { if (g_link_log_level >= LINK_LOG_ERROR) { fprintf(stderr, "[LINK_ERR] " fmt "\n", ##__VA_ARGS__); } } while(0)
+#define LINK_LOG_I(fmt, ...) do { if (g_link_log_level >= LINK_LOG_INFO) { printf("[LINK_INFO] " fmt "\n", ##__VA_ARGS__); } } while(0)
+#define LINK_LOG_D(fmt, ...) do { if (g_link_log_level >= LINK_LOG_DEBUG) { printf("[LINK_DBG] " fmt "\n", ##__VA_ARGS__); } } while(0)
+
+// Forward declaration - implemented in graphics_task.cpp
+extern int init_display_callback(uint16_t width, uint16_t height, uint8_t color_depth);
+
+// Receive buffer sizing: starts large enough for one max-payload frame
+// (envelope + CRC + COBS overhead) and doubles up to RX_BUFFER_MAX_SIZE
+#define RX_BUFFER_INIT_SIZE COBS_ENC_MAX(FMRB_LINK_MAX_PAYLOAD_SIZE + 16)
+#define RX_BUFFER_MAX_SIZE  (512 * 1024)
+#define RX_READ_MIN         1024
+
+// Link statistics. Framing, CRC and envelope parsing never allocate;
+// rx_buf_allocs only counts the growth of the receive stream and chunk
+// reassembly buffers (it stays flat once they have reached their working size).
+// Allocations made by the command handlers are not included.
+static comm_link_stats_t g_rx_stats;
+
+// Response (ACK) transmit buffer, flushed once per receive pass
+#define TX_ENVELOPE_MAX 16
+#define TX_BUFFER_SIZE  (2 * COBS_ENC_MAX(TX_ENVELOPE_MAX + FMRB_LINK_MAX_PAYLOAD_SIZE + 4))
+
+// Pull mode: flushed responses wait here until the transport takes them
+#define TX_QUEUE_SIZE   (2 * TX_BUFFER_SIZE)
+
+typedef struct {
+    uint8_t buf[TX_BUFFER_SIZE];
+    size_t len;
+    bool batching;          // Inside a receive pass: queue instead of writing
+    uint8_t ack_mode;       // FMRB_LINK_ACK_MODE_*
+    bool binary_hdr;        // FMRB_LINK_FEATURE_BINARY_HDR negotiated via VERSION
+    uint8_t pending_type;   // Pending cumulative ACK
+    uint8_t pending_seq;
+    uint16_t pending_count;
+    uint8_t raw[TX_ENVELOPE_MAX + FMRB_LINK_MAX_PAYLOAD_SIZE];  // Frame before COBS (too big for the comm_task stack)
+} tx_stream_t;
+
+static tx_stream_t g_tx;
+
+// Transport writer (push mode) or outbound byte ring (pull mode)
+static comm_link_write_fn g_write_fn = NULL;
+
+typedef struct {
+    uint8_t *buf;
+    size_t head;
+    size_t len;
+} tx_queue_t;
+
+static tx_queue_t g_txq;
+
+// Chunked transfer reassembly (FMRB_LINK_FLAG_CHUNKED)
+static fmrb_link_chunk_rx_t g_chunk_rx;
+
+static int process_chunk(uint8_t type, uint8_t seq, uint8_t sub_cmd, const uint8_t *payload, size_t payload_len);
+static int dispatch_message(uint8_t type, uint8_t seq, uint8_t sub_cmd, const uint8_t *payload, size_t payload_len);
+static int send_response(uint8_t type, uint8_t seq, uint8_t response, const uint8_t *response_data, uint16_t response_len);
+static int tx_ack_barrier(void);
+static int tx_flush(void);
+
+#define MSGPACK_FIXARRAY_4 FMRB_LINK_FRAME_MSGPACK
+
+// Read a msgpack unsigned integer (positive fixint / uint8..uint64)
+static int envelope_read_uint(const uint8_t **p, const uint8_t *end, uint64_t *out) {
+    const uint8_t *q = *p;
+    if (q >= end) return -1;
+
+    uint8_t tag = *q++;
+    size_t n;
+    if (tag <= 0x7F) {
+        *out = tag;
+        *p = q;
+        return 0;
+    }
+    switch (tag) {
+        case 0xCC: n = 1; break;
+        case 0xCD: n = 2; break;
+        case 0xCE: n = 4; break;
+        case 0xCF: n = 8; break;
+        default: return -1;
+    }
+    if ((size_t)(end - q) < n) return -1;
+
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) {
+        v = (v << 8) | q[i];  // msgpack is big-endian
+    }
+    *out = v;
+    *p = q + n;
+    return 0;
+}
+
+// Parse the fixed [type, seq, sub_cmd, payload] envelope without allocating.
+// payload must be bin8/16/32 or nil; the returned pointer references the input buffer.
+static int envelope_parse(const uint8_t *data, size_t len,
+                          uint8_t *type, uint8_t *seq, uint8_t *sub_cmd,
+                          const uint8_t **payload, size_t *payload_len) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+    uint64_t v;
+
+    if (p >= end || *p++ != MSGPACK_FIXARRAY_4) {
+        return -1;
+    }
+
+    if (envelope_read_uint(&p, end, &v) != 0) return -1;
+    *type = (uint8_t)v;
+    if (envelope_read_uint(&p, end, &v) != 0) return -1;
+    *seq = (uint8_t)v;
+    if (envelope_read_uint(&p, end, &v) != 0) return -1;
+    *sub_cmd = (uint8_t)v;
+
+    if (p >= end) return -1;
+    uint8_t tag = *p++;
+    size_t n;
+    switch (tag) {
+        case 0xC0:  // nil
+            *payload = NULL;
+            *payload_len = 0;
+            return 0;
+        case 0xC4: n = 1; break;
+        case 0xC5: n = 2; break;
+        case 0xC6: n = 4; break;
+        default: return -1;
+    }
+    if ((size_t)(end - p) < n) return -1;
+
+    size_t bin_len = 0;
+    for (size_t i = 0; i < n; i++) {
+        bin_len = (bin_len << 8) | p[i];
+    }
+    p += n;
+    if ((size_t)(end - p) < bin_len) return -1;
+
+    *payload = p;
+    *payload_len = bin_len;
+    return 0;
+}
+
+// Parse a binary fast-path frame: FMRB_LINK_FRAME_BINARY | fmrb_link_frame_hdr_t | sub_cmd | payload[len]
+static int binary_parse(const uint8_t *data, size_t len,
+                        uint8_t *type, uint8_t *seq, uint8_t *sub_cmd,
+                        const uint8_t **payload, size_t *payload_len) {
+    fmrb_link_frame_hdr_t hdr;
+    if (len < FMRB_LINK_BIN_HDR_SIZE || data[0] != FMRB_LINK_FRAME_BINARY) {
+        return -1;
+    }
+    memcpy(&hdr, data + 1, sizeof(hdr));
+    if ((size_t)hdr.len != len - FMRB_LINK_BIN_HDR_SIZE) {
+        return -1;
+    }
+
+    *type = hdr.type;
+    *seq = hdr.seq;
+    *sub_cmd = data[1 + sizeof(hdr)];
+    *payload = hdr.len ? data + FMRB_LINK_BIN_HDR_SIZE : NULL;
+    *payload_len = hdr.len;
+    return 0;
+}
+
+// Decode a COBS frame in place. COBS never writes ahead of the read position,
+// so the decoded bytes overwrite the encoded ones inside the receive buffer.
+static int process_cobs_frame(uint8_t *frame, size_t encoded_len) {
+    g_rx_stats.frames_rx++;
+
+    // COBS decode (in place) with the CRC32 computed block by block as it decodes
+    uint32_t calculated_crc;
+    ssize_t decoded_len = fmrb_link_cobs_decode_crc(frame, encoded_len, frame, &calculated_crc);
+    if (decoded_len < (ssize_t)FMRB_LINK_CRC_SIZE) {
+        fprintf(stderr, "COBS decode failed or frame too small\n");
+        g_rx_stats.frames_err++;
+        return -1;
+    }
+
+    // Separate msgpack data and CRC32
+    size_t msgpack_len = decoded_len - FMRB_LINK_CRC_SIZE;
+    const uint8_t *msgpack_data = frame;
+    uint32_t received_crc;
+    memcpy(&received_crc, frame + msgpack_len, sizeof(uint32_t));
+
+    // Verify CRC32
+    if (received_crc != calculated_crc) {
+        fprintf(stderr, "CRC32 mismatch: expected=0x%08x, actual=0x%08x\n", calculated_crc, received_crc);
+        g_rx_stats.frames_err++;
+        return -1;
+    }
+
+    // Unpack msgpack array: [type, seq, sub_cmd, payload]
+    uint8_t type, seq, sub_cmd;
+    const uint8_t *payload = NULL;
+    size_t payload_len = 0;
+
+    if (g_tx.binary_hdr && msgpack_len > 0 && msgpack_data[0] == FMRB_LINK_FRAME_BINARY) {
+        // Binary fast path: fixed header + raw struct payload
+        if (binary_parse(msgpack_data, msgpack_len, &type, &seq, &sub_cmd, &payload, &payload_len) != 0) {
+            fprintf(stderr, "Invalid binary frame: length mismatch (frame=%zu)\n", msgpack_len);
+            g_rx_stats.frames_err++;
+            return -1;
+        }
+    } else if (envelope_parse(msgpack_data, msgpack_len, &type, &seq, &sub_cmd, &payload, &payload_len) != 0) {
+        fprintf(stderr, "Invalid msgpack format: expected [type, seq, sub_cmd, bin|nil]\n");
+        g_rx_stats.frames_err++;
+        return -1;
+    }
+
+    // Debug log for GRAPHICS commands (controlled by log level)
+    if ((type & 0x7F) == FMRB_LINK_TYPE_GRAPHICS) {
+        LINK_LOG_D("RX msgpack: type=%d seq=%d sub_cmd=0x%02x payload_len=%zu msgpack_len=%zu",
+               type, seq, sub_cmd, payload_len, msgpack_len);
+        if (g_link_log_level >= LINK_LOG_DEBUG) {
+            printf("RX msgpack bytes (%zu): ", msgpack_len);
+            for (size_t i = 0; i < msgpack_len && i < 64; i++) {
+                printf("%02X ", msgpack_data[i]);
+                if ((i + 1) % 16 == 0) printf("\n");
+            }
+            if (msgpack_len > 0) printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    if (type & FMRB_LINK_FLAG_CHUNKED) {
+        return process_chunk(type, seq, sub_cmd, payload, payload_len);
+    }
+
+    return dispatch_message(type, seq, sub_cmd, payload, payload_len);
+}
+
+// Chunked transfer: reassemble, return credit ACKs, dispatch on completion
+static int process_chunk(uint8_t type, uint8_t seq, uint8_t sub_cmd, const uint8_t *payload, size_t payload_len) {
+    fmrb_link_frame_chunk_ack_t ack;
+    const uint8_t *data = NULL;
+    size_t len = 0;
+
+    fmrb_link_chunk_result_t res = fmrb_link_chunk_receive(&g_chunk_rx, sub_cmd, payload, payload_len,
+                                                           &ack, &data, &len);
+    switch (res) {
+        case FMRB_LINK_CHUNK_PENDING:
+            return 0;
+
+        case FMRB_LINK_CHUNK_DROPPED:
+            return -1;  // Already NACKed, the sender rewinds to next_offset
+
+        case FMRB_LINK_CHUNK_SEND_ACK:
+            LINK_LOG_D("Chunk ACK: lane=%u gen=%u credit=%u next_offset=%u",
+                       ack.chunk_id, ack.gen, ack.credit, (unsigned)ack.next_offset);
+            return send_response(type, seq, FMRB_LINK_RESPONSE_MSG_ACK, (const uint8_t*)&ack, sizeof(ack));
+
+        case FMRB_LINK_CHUNK_COMPLETE:
+            LINK_LOG_D("Chunked message complete: sub_cmd=0x%02x len=%zu", sub_cmd, len);
+            return dispatch_message(type & ~FMRB_LINK_FLAG_CHUNKED, seq, sub_cmd, data, len);
+
+        case FMRB_LINK_CHUNK_ERROR:
+        default:
+            LINK_LOG_I("Chunk NACK: lane=%u gen=%u next_offset=%u",
+                       ack.chunk_id, ack.gen, (unsigned)ack.next_offset);
+            send_response(type, seq, FMRB_LINK_RESPONSE_MSG_NACK, (const uint8_t*)&ack, sizeof(ack));
+            return -1;
+    }
+}
+
+// Route a complete message to its handler
+static int dispatch_message(uint8_t type, uint8_t seq, uint8_t sub_cmd, const uint8_t *payload, size_t payload_len) {
+    // sub_cmd contains the command type, payload contains only structure data
+    // Pass sub_cmd as cmd_type to handlers
+    const uint8_t *cmd_buffer = payload;
+    size_t cmd_len = payload_len;
+
+    // Process based on type
+    int result = 0;
+    switch (type & 0x7F) {
+        case FMRB_LINK_TYPE_CONTROL:
+            // For control commands, sub_cmd is the command type
+            if (sub_cmd == FMRB_LINK_CONTROL_VERSION && cmd_len >= 1) {
+                // Version check request (optionally followed by a feature mask)
+                uint8_t remote_version = cmd_buffer[0];
+                uint8_t local_version = FMRB_LINK_PROTOCOL_VERSION;
+                uint8_t remote_features = (cmd_len >= sizeof(fmrb_control_version_ext_t)) ? cmd_buffer[1] : 0;
+                fmrb_control_version_ext_t resp = {
+                    .version = local_version,
+                    .features = (uint8_t)(remote_features & FMRB_LINK_FEATURES_SUPPORTED),
+                };
+
+                printf("Received VERSION check: remote=%d, local=%d, features=0x%02x, seq=%u\n",
+                       remote_version, local_version, remote_features, seq);
+
+                // Send version response via ACK with version (and accepted features) in payload.
+                // The ACK still uses the current framing; the new features apply from the next frame.
+                uint16_t resp_len = (cmd_len >= sizeof(fmrb_control_version_ext_t)) ? sizeof(resp) : sizeof(local_version);
+                result = comm_link_send_ack(type, seq, (const uint8_t*)&resp, resp_len);
+                tx_ack_barrier();
+
+                if (result == 0) {
+                    printf("VERSION ACK sent successfully\n");
+                    g_tx.binary_hdr = (resp.features & FMRB_LINK_FEATURE_BINARY_HDR) != 0;
+                    if (g_tx.binary_hdr) {
+                        printf("Binary frame header enabled\n");
+                    }
+                } else {
+                    fprintf(stderr, "VERSION ACK send failed: result=%d\n", result);
+                }
+
+                if (remote_version != local_version) {
+                    fprintf(stderr, "WARNING: Protocol version mismatch! remote=%d, local=%d\n",
+                            remote_version, local_version);
+                }
+            } else if (sub_cmd == FMRB_LINK_CONTROL_INIT_DISPLAY && cmd_len >= sizeof(fmrb_control_init_display_t)) {
+                const fmrb_control_init_display_t *init_cmd = (const fmrb_control_init_display_t*)cmd_buffer;
+                printf("Received INIT_DISPLAY: %dx%d, %d-bit\n",
+                       init_cmd->width, init_cmd->height, init_cmd->color_depth);
+                result = init_display_callback(init_cmd->width, init_cmd->height, init_cmd->color_depth);
+
+                // Send ACK to prevent retransmission
+                if (result == 0) {
+                    comm_link_send_ack(type, seq, NULL, 0);
+                }
+            } else if (sub_cmd == FMRB_LINK_CONTROL_SET_ACK_MODE && cmd_len >= sizeof(fmrb_control_ack_mode_t)) {
+                const fmrb_control_ack_mode_t *mode_cmd = (const fmrb_control_ack_mode_t*)cmd_buffer;
+                if (mode_cmd->mode > FMRB_LINK_ACK_MODE_CUMULATIVE) {
+                    fprintf(stderr, "Unknown ACK mode: %u\n", mode_cmd->mode);
+                    result = -1;
+                    break;
+                }
+                // Acknowledge with the old mode, then switch
+                result = comm_link_send_ack(type, seq, NULL, 0);
+                tx_ack_barrier();
+                g_tx.ack_mode = mode_cmd->mode;
+                LINK_LOG_I("ACK mode set to %s",
+                       g_tx.ack_mode == FMRB_LINK_ACK_MODE_CUMULATIVE ? "cumulative" : "each");
+            } else {
+                fprintf(stderr, "Unknown control command: 0x%02x\n", sub_cmd);
+                result = -1;
+            }
+            break;
+
+        case FMRB_LINK_TYPE_GRAPHICS:
+            // Pass msg_type and sub_cmd as graphics cmd_type
+            result = graphics_handler_process_command(type, sub_cmd, seq, cmd_buffer, cmd_len);
+            // Send ACK to prevent retransmission
+            if (result == 0) {
+                comm_link_send_ack(type, seq, NULL, 0);
+            }
+            break;
+
+        case FMRB_LINK_TYPE_AUDIO:
+            result = audio_handler_process_command(cmd_buffer, cmd_len);
+            break;
+
+        default:
+            fprintf(stderr, "Unknown frame type: %u\n", type);
+            result = -1;
+            break;
+    }
+
+    // cmd_buffer points into the receive or chunk buffer, nothing to free
+    return result;
+}
+
+// Stream reassembly buffer. Frames are decoded in place, so they must be
+// contiguous: the buffer is linear, grows by doubling when a single frame does
+// not fit, and is only compacted when the tail runs out of room.
+//
+//   [0 .. rx_head)        consumed, reusable after compaction
+//   [rx_head .. rx_scan)  partial frame, already scanned (no 0x00)
+//   [rx_scan .. rx_tail)  received, not scanned yet
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t head;
+    size_t scan;
+    size_t tail;
+    bool discarding;  // Oversized frame: drop bytes until the next 0x00
+} rx_stream_t;
+
+static rx_stream_t g_rx;
+
+static void rx_stream_reset(void) {
+    g_rx.head = 0;
+    g_rx.scan = 0;
+    g_rx.tail = 0;
+    g_rx.discarding = false;
+}
+
+static void rx_stream_free(void) {
+    free(g_rx.buf);
+    g_rx.buf = NULL;
+    g_rx.cap = 0;
+    rx_stream_reset();
+}
+
+// Make room for at least min_free bytes after rx_tail.
+// Returns 0 on success, -1 if the pending frame exceeds RX_BUFFER_MAX_SIZE.
+static int rx_stream_reserve(size_t min_free) {
+    if (g_rx.cap - g_rx.tail >= min_free) {
+        return 0;
+    }
+
+    // Slide the pending partial frame to the front (cheap: only unconsumed bytes move)
+    if (g_rx.head > 0) {
+        size_t pending = g_rx.tail - g_rx.head;
+        if (pending > 0) {
+            memmove(g_rx.buf, g_rx.buf + g_rx.head, pending);
+        }
+        g_rx.scan -= g_rx.head;
+        g_rx.tail = pending;
+        g_rx.head = 0;
+        if (g_rx.cap - g_rx.tail >= min_free) {
+            return 0;
+        }
+    }
+
+    size_t new_cap = g_rx.cap ? g_rx.cap : RX_BUFFER_INIT_SIZE;
+    while (new_cap - g_rx.tail < min_free) {
+        new_cap *= 2;
+    }
+    if (new_cap > RX_BUFFER_MAX_SIZE) {
+        return -1;
+    }
+
+    uint8_t *new_buf = (uint8_t*)realloc(g_rx.buf, new_cap);
+    if (!new_buf) {
+        fprintf(stderr, "Failed to grow receive buffer to %zu bytes\n", new_cap);
+        return -1;
+    }
+    g_rx_stats.rx_buf_allocs++;
+    LINK_LOG_I("Receive buffer grown: %zu -> %zu bytes", g_rx.cap, new_cap);
+    g_rx.buf = new_buf;
+    g_rx.cap = new_cap;
+    return 0;
+}
+
+uint8_t *comm_link_rx_reserve(size_t *avail) {
+    // Keep at least RX_READ_MIN bytes of room for the next read
+    if (rx_stream_reserve(RX_READ_MIN) != 0) {
+        // A single frame has outgrown the maximum: drop it and resync on the next 0x00
+        fprintf(stderr, "Frame exceeds %u bytes, discarding until next delimiter\n",
+                (unsigned)RX_BUFFER_MAX_SIZE);
+        g_rx_stats.frames_err++;
+        rx_stream_reset();
+        g_rx.discarding = true;
+        if (!g_rx.buf) {
+            *avail = 0;
+            return NULL;
+        }
+    }
+
+    *avail = g_rx.cap - g_rx.tail;
+    return g_rx.buf + g_rx.tail;
+}
+
+int comm_link_rx_commit(size_t len) {
+    g_rx.tail += len;
+
+    // Process complete COBS frames (terminated by 0x00)
+    // Responses generated during the pass are coalesced into one write
+    int messages_processed = 0;
+    g_tx.batching = true;
+
+    while (g_rx.scan < g_rx.tail) {
+        // Look for frame terminator (0x00)
+        uint8_t *term = (uint8_t*)memchr(g_rx.buf + g_rx.scan, COBS_FRAME_TERM, g_rx.tail - g_rx.scan);
+        if (!term) {
+            // No complete frame yet; remember how far we have scanned
+            g_rx.scan = g_rx.tail;
+            break;
+        }
+
+        size_t frame_end = term - g_rx.buf;
+        size_t frame_len = frame_end - g_rx.head;
+
+        if (g_rx.discarding) {
+            // Tail of an oversized frame
+            g_rx.discarding = false;
+        } else if (frame_len > 0) {
+            // Process COBS frame (without the 0x00 terminator)
+            if (process_cobs_frame(g_rx.buf + g_rx.head, frame_len) == 0) {
+                messages_processed++;
+            } else {
+                // Not acknowledged: a later cumulative ACK must not cover it
+                tx_ack_barrier();
+            }
+        }
+
+        // Move to next frame (skip the 0x00 terminator)
+        g_rx.head = frame_end + 1;
+        g_rx.scan = g_rx.head;
+    }
+
+    // Everything consumed (or only oversized data left): rewind without copying
+    if (g_rx.head == g_rx.tail || g_rx.discarding) {
+        g_rx.head = 0;
+        g_rx.scan = 0;
+        g_rx.tail = 0;
+    }
+
+    g_tx.batching = false;
+    tx_ack_barrier();
+    if (g_tx.len > 0) {
+        tx_flush();
+    }
+
+    return messages_processed;
+}
+
+int comm_link_rx_feed(const uint8_t *data, size_t len) {
+    int messages_processed = 0;
+
+    // Idle padding between frames (e.g. a mostly empty SPI transaction) carries no data
+    if (g_rx.head == g_rx.tail && !g_rx.discarding) {
+        while (len > 0 && *data == COBS_FRAME_TERM) {
+            data++;
+            len--;
+        }
+    }
+
+    while (len > 0) {
+        size_t avail;
+        uint8_t *dst = comm_link_rx_reserve(&avail);
+        if (!dst) {
+            return messages_processed;
+        }
+        size_t n = (len < avail) ? len : avail;
+        memcpy(dst, data, n);
+        messages_processed += comm_link_rx_commit(n);
+        data += n;
+        len -= n;
+    }
+    return messages_processed;
+}
+
+// Pull mode: move the encoded responses into the outbound ring
+static int tx_queue_push(const uint8_t *data, size_t len) {
+    if (!g_txq.buf) {
+        g_txq.buf = (uint8_t*)malloc(TX_QUEUE_SIZE);
+        if (!g_txq.buf) {
+            fprintf(stderr, "Failed to allocate response queue\n");
+            return -1;
+        }
+    }
+    if (TX_QUEUE_SIZE - g_txq.len < len) {
+        // Peer is not clocking responses out; it will retransmit
+        fprintf(stderr, "Response queue full, dropping %zu bytes\n", len);
+        g_rx_stats.tx_dropped += len;
+        return -1;
+    }
+
+    size_t tail = (g_txq.head + g_txq.len) % TX_QUEUE_SIZE;
+    size_t first = TX_QUEUE_SIZE - tail;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(g_txq.buf + tail, data, first);
+    memcpy(g_txq.buf, data + first, len - first);
+    g_txq.len += len;
+    return 0;
+}
+
+size_t comm_link_tx_pull(uint8_t *dst, size_t max) {
+    size_t n = (g_txq.len < max) ? g_txq.len : max;
+    size_t first = TX_QUEUE_SIZE - g_txq.head;
+    if (first > n) {
+        first = n;
+    }
+    if (n > 0) {
+        memcpy(dst, g_txq.buf + g_txq.head, first);
+        memcpy(dst + first, g_txq.buf, n - first);
+        g_txq.head = (g_txq.head + n) % TX_QUEUE_SIZE;
+        g_txq.len -= n;
+    }
+    return n;
+}
+
+// Write a msgpack unsigned integer (same encoding as msgpack_pack_uint8)
+static uint8_t *envelope_write_uint8(uint8_t *p, uint8_t v) {
+    if (v > 0x7F) {
+        *p++ = 0xCC;
+    }
+    *p++ = v;
+    return p;
+}
+
+// Build msgpack response: [type, seq, sub_cmd=response, payload]
+static uint8_t *envelope_write(uint8_t *p, uint8_t type, uint8_t seq, uint8_t response,
+                               const uint8_t *response_data, uint16_t response_len) {
+    *p++ = MSGPACK_FIXARRAY_4;
+    p = envelope_write_uint8(p, type);
+    p = envelope_write_uint8(p, seq);
+    p = envelope_write_uint8(p, response);
+
+    // Pack response data as binary
+    if (response_data && response_len > 0) {
+        if (response_len <= 0xFF) {
+            *p++ = 0xC4;
+            *p++ = (uint8_t)response_len;
+        } else {
+            *p++ = 0xC5;
+            *p++ = (uint8_t)(response_len >> 8);
+            *p++ = (uint8_t)response_len;
+        }
+        memcpy(p, response_data, response_len);
+        p += response_len;
+    } else {
+        *p++ = 0xC0;  // nil
+    }
+    return p;
+}
+
+// Build binary fast-path response: FMRB_LINK_FRAME_BINARY | fmrb_link_frame_hdr_t | response | payload
+static uint8_t *binary_write(uint8_t *p, uint8_t type, uint8_t seq, uint8_t response,
+                             const uint8_t *response_data, uint16_t response_len) {
+    fmrb_link_frame_hdr_t hdr = { type, seq, (uint16_t)(response_data ? response_len : 0) };
+    *p++ = FMRB_LINK_FRAME_BINARY;
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+    *p++ = response;
+    if (hdr.len) {
+        memcpy(p, response_data, hdr.len);
+        p += hdr.len;
+    }
+    return p;
+}
+
+// Flush queued response frames with a single transport write
+static int tx_flush(void) {
+    if (g_tx.len == 0) {
+        return 0;
+    }
+
+    int ret = g_write_fn ? g_write_fn(g_tx.buf, g_tx.len) : tx_queue_push(g_tx.buf, g_tx.len);
+    if (ret == 0) {
+        g_rx_stats.tx_writes++;
+    }
+    g_tx.len = 0;
+    return ret;
+}
+
+// Encode one response frame into the TX buffer: COBS([type, seq, response, payload] + CRC32)
+static int tx_queue_frame(uint8_t type, uint8_t seq, uint8_t response, const uint8_t *response_data, uint16_t response_len) {
+    if (response_len > FMRB_LINK_MAX_PAYLOAD_SIZE) {
+        fprintf(stderr, "ACK payload too large: %u\n", response_len);
+        return -1;
+    }
+
+    uint8_t *raw = g_tx.raw;
+    uint8_t *p = raw;
+
+    if (g_tx.binary_hdr) {
+        p = binary_write(p, type, seq, response, response_data, response_len);
+    } else {
+        p = envelope_write(p, type, seq, response, response_data, response_len);
+    }
+
+    // COBS encode frame + CRC32 (computed while encoding, 0x00 terminated)
+    // straight into the TX buffer
+    size_t msg_len = p - raw;
+    if (TX_BUFFER_SIZE - g_tx.len < COBS_ENC_MAX(msg_len + FMRB_LINK_CRC_SIZE)) {
+        if (tx_flush() != 0) {
+            return -1;
+        }
+    }
+    g_tx.len += fmrb_link_cobs_encode_crc(raw, msg_len, g_tx.buf + g_tx.len);
+    g_rx_stats.tx_frames++;
+
+    LINK_LOG_D("%s queued: type=%u seq=%u response_len=%u",
+               response == FMRB_LINK_RESPONSE_MSG_ACK ? "ACK" :
+               response == FMRB_LINK_RESPONSE_MSG_NACK ? "NACK" : "CUMULATIVE ACK",
+               type, seq, response_len);
+    return 0;
+}
+
+// Emit the pending cumulative ACK, if any. Called before anything that must not
+// be covered by it: a failed message, a different type, or a response with payload.
+static int tx_ack_barrier(void) {
+    if (g_tx.pending_count == 0) {
+        return 0;
+    }
+
+    uint8_t response = (g_tx.pending_count == 1) ? FMRB_LINK_RESPONSE_MSG_ACK
+                                                 : FMRB_LINK_RESPONSE_MSG_ACK_CUMULATIVE;
+    g_tx.pending_count = 0;
+    return tx_queue_frame(g_tx.pending_type, g_tx.pending_seq, response, NULL, 0);
+}
+
+// Send ACK/NACK response: [type, seq, response, payload]
+// While a receive pass is in progress responses are queued and flushed together
+// at the end of the pass; otherwise they are written immediately.
+static int send_response(uint8_t type, uint8_t seq, uint8_t response, const uint8_t *response_data, uint16_t response_len) {
+    bool plain_ack = (response == FMRB_LINK_RESPONSE_MSG_ACK) && (!response_data || response_len == 0);
+
+    if (plain_ack && g_tx.ack_mode == FMRB_LINK_ACK_MODE_CUMULATIVE && g_tx.batching) {
+        // Fold into the pending cumulative ACK ("everything up to seq succeeded")
+        if (g_tx.pending_count > 0 && g_tx.pending_type != type) {
+            if (tx_ack_barrier() != 0) {
+                return -1;
+            }
+        }
+        g_tx.pending_type = type;
+        g_tx.pending_seq = seq;
+        g_tx.pending_count++;
+        g_rx_stats.acks_coalesced++;
+        return 0;
+    }
+
+    if (tx_ack_barrier() != 0) {
+        return -1;
+    }
+    if (tx_queue_frame(type, seq, response, response_data, response_len) != 0) {
+        return -1;
+    }
+    return g_tx.batching ? 0 : tx_flush();
+}
+
+// Send ACK response with optional payload
+int comm_link_send_ack(uint8_t type, uint8_t seq, const uint8_t *response_data, uint16_t response_len) {
+    return send_response(type, seq, FMRB_LINK_RESPONSE_MSG_ACK, response_data, response_len);
+}
+
+int comm_link_init(comm_link_write_fn write_fn) {
+    g_write_fn = write_fn;
+    comm_link_reset();
+    return 0;
+}
+
+void comm_link_reset(void) {
+    rx_stream_reset();
+    fmrb_link_chunk_reset(&g_chunk_rx);
+    g_tx.len = 0;
+    g_tx.pending_count = 0;
+    g_tx.ack_mode = FMRB_LINK_ACK_MODE_EACH;
+    g_tx.binary_hdr = false;
+    g_txq.head = 0;
+    g_txq.len = 0;
+}
+
+void comm_link_cleanup(void) {
+    rx_stream_free();
+    fmrb_link_chunk_free(&g_chunk_rx);
+    free(g_txq.buf);
+    g_txq.buf = NULL;
+    g_txq.head = 0;
+    g_txq.len = 0;
+}
+
+void comm_link_get_stats(comm_link_stats_t *stats) {
+    if (stats) {
+        *stats = g_rx_stats;
+        stats->rx_buf_allocs += g_chunk_rx.allocs;
+    }
+}
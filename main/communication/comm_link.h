@@ -0,0 +1,112 @@
+#ifndef COMM_LINK_H
+#define COMM_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Transport-independent link layer
+ *
+ * Turns a received byte stream into COBS frames, verifies the CRC32, parses
+ * the msgpack envelope (or the negotiated binary header), reassembles chunked
+ * messages and dispatches them to the graphics/audio handlers. Responses are
+ * COBS encoded into a transmit buffer and coalesced per receive pass.
+ *
+ * Transports only move bytes: the socket server feeds read() data in and
+ * writes responses out directly (push mode); SPI transports feed MOSI bytes in
+ * and pull response bytes out into the next MISO buffer (pull mode).
+ */
+
+/**
+ * @brief Link statistics
+ */
+typedef struct {
+    uint32_t frames_rx;       // COBS frames handed to the decoder
+    uint32_t frames_err;      // Frames rejected (COBS, CRC or envelope error)
+    uint32_t rx_buf_allocs;   // Receive stream and chunk reassembly buffer (re)allocations
+    uint32_t tx_frames;       // Response frames encoded
+    uint32_t tx_writes;       // write() flushes of the response buffer
+    uint32_t acks_coalesced;  // Plain ACKs folded into a cumulative ACK
+    uint32_t tx_dropped;      // Response bytes dropped (pull mode queue full)
+} comm_link_stats_t;
+
+/**
+ * @brief Write encoded response frames to the transport
+ * @param data Encoded bytes (one or more 0x00-terminated COBS frames)
+ * @param len Number of bytes
+ * @return 0 on success, -1 on error (no peer, write failed)
+ */
+typedef int (*comm_link_write_fn)(const uint8_t *data, size_t len);
+
+/**
+ * @brief Initialize the link layer
+ * @param write_fn Push-mode transport writer, or NULL for pull mode (comm_link_tx_pull)
+ * @return 0 on success, -1 on error
+ */
+int comm_link_init(comm_link_write_fn write_fn);
+
+/**
+ * @brief Get room for received bytes at the end of the stream buffer
+ * @param avail Set to the number of bytes that may be written
+ * @return Write pointer, or NULL on allocation failure
+ */
+uint8_t *comm_link_rx_reserve(size_t *avail);
+
+/**
+ * @brief Process bytes written into the area returned by comm_link_rx_reserve()
+ * @param len Number of bytes written
+ * @return Number of messages processed
+ */
+int comm_link_rx_commit(size_t len);
+
+/**
+ * @brief Copy received bytes into the stream and process them
+ * @param data Received bytes (0x00 padding between frames is ignored)
+ * @param len Number of bytes
+ * @return Number of messages processed
+ */
+int comm_link_rx_feed(const uint8_t *data, size_t len);
+
+/**
+ * @brief Take queued response bytes (pull mode only)
+ * @param dst Destination buffer
+ * @param max Maximum number of bytes to copy
+ * @return Number of bytes copied
+ */
+size_t comm_link_tx_pull(uint8_t *dst, size_t max);
+
+/**
+ * @brief Send ACK response with optional payload
+ * @param type Message type
+ * @param seq Sequence number
+ * @param response_data Response payload data (can be NULL)
+ * @param response_len Response payload length
+ * @return 0 on success, -1 on error
+ */
+int comm_link_send_ack(uint8_t type, uint8_t seq, const uint8_t *response_data, uint16_t response_len);
+
+/**
+ * @brief Drop all per-connection state (partial frames, transfers, negotiated modes)
+ */
+void comm_link_reset(void);
+
+/**
+ * @brief Release link buffers
+ */
+void comm_link_cleanup(void);
+
+/**
+ * @brief Get link statistics
+ * @param stats Output statistics
+ */
+void comm_link_get_stats(comm_link_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMM_LINK_H
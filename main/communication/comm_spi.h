@@ -0,0 +1,27 @@
+#ifndef COMM_SPI_H
+#define COMM_SPI_H
+
+/**
+ * SPI link geometry, shared by the ESP32 SPI slave and the Linux simulator
+ *
+ * The master clocks full-duplex transactions of up to COMM_SPI_XFER_SIZE bytes.
+ * MOSI carries the COBS frame stream from the master, MISO the response stream
+ * from the slave. Frames may span transactions and unused bytes are padded with
+ * 0x00, which the frame decoder treats as empty frames.
+ *
+ * MISO data for a transaction is fixed when the transaction is queued, so with
+ * COMM_SPI_QUEUE_DEPTH transactions queued a response to transaction N is
+ * clocked out in transaction N + COMM_SPI_QUEUE_DEPTH at the earliest.
+ */
+
+// Maximum transaction size - MUST match master (DMA buffer, multiple of 4)
+#define COMM_SPI_XFER_SIZE    4096
+
+// Transactions queued to the slave driver (DMA descriptors in flight)
+#define COMM_SPI_QUEUE_DEPTH  4
+
+// Simulator: Unix socket the simulated master connects to, and modeled SCLK
+#define COMM_SPI_SIM_PATH     "/tmp/fmrb_spi_sim"
+#define COMM_SPI_SIM_CLOCK_HZ 20000000
+
+#endif // COMM_SPI_H
@@ -0,0 +1,287 @@
+#include "comm_interface.h"
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+
+// Simulated SPI slave for Linux
+//
+// Models the ESP32 SPI slave link without hardware: a simulated master connects
+// to COMM_SPI_SIM_PATH and exchanges fixed-size transactions of
+// COMM_SPI_XFER_SIZE bytes (MOSI in, MISO out). Each transaction occupies the
+// bus for COMM_SPI_XFER_SIZE * 8 / COMM_SPI_SIM_CLOCK_HZ, and MISO buffers are
+// prepared COMM_SPI_QUEUE_DEPTH transactions ahead, as with the DMA queue on
+// hardware. MOSI bytes go through the same comm_link frame decoder as the
+// socket server.
+
+#include "comm_spi.h"
+#include "comm_link.h"
+#include "comm_wake.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+
+static int server_fd = -1;
+static int client_fd = -1;
+static int sim_running = 0;
+
+// Self-pipe used to interrupt spi_sim_wait() (e.g. on shutdown)
+static comm_wake_t wake = COMM_WAKE_INIT;
+
+// Transaction being clocked in from the master
+static uint8_t mosi_buf[COMM_SPI_XFER_SIZE];
+static size_t mosi_len = 0;
+static int64_t mosi_start_us = 0;
+
+// MISO buffers queued ahead of the master, consumed in order
+static uint8_t miso_bufs[COMM_SPI_QUEUE_DEPTH][COMM_SPI_XFER_SIZE];
+static int miso_head = 0;
+
+// End of the previous transaction on the simulated bus
+static int64_t bus_free_us = 0;
+static int64_t xfer_time_us = 0;
+
+static uint32_t transactions = 0;
+
+static int64_t spi_sim_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void spi_sim_reset(void) {
+    mosi_len = 0;
+    miso_head = 0;
+    memset(miso_bufs, 0, sizeof(miso_bufs));
+    comm_link_reset();
+}
+
+static void spi_sim_disconnect(void) {
+    printf("SPI sim: master disconnected (transactions=%u)\n", (unsigned)transactions);
+    close(client_fd);
+    client_fd = -1;
+    spi_sim_reset();
+}
+
+static int spi_sim_accept(void) {
+    if (client_fd != -1) {
+        return 0;
+    }
+
+    client_fd = accept(server_fd, NULL, NULL);
+    if (client_fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            fprintf(stderr, "SPI sim: failed to accept master: %s\n", strerror(errno));
+        }
+        return -1;
+    }
+
+    int flags = fcntl(client_fd, F_GETFL, 0);
+    fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
+
+    transactions = 0;
+    bus_free_us = 0;
+    printf("SPI sim: master connected\n");
+    return 0;
+}
+
+// Clock out one MISO buffer (blocking until the master has taken all of it)
+static int spi_sim_write_miso(const uint8_t *data) {
+    size_t off = 0;
+
+    while (off < COMM_SPI_XFER_SIZE) {
+        ssize_t written = write(client_fd, data + off, COMM_SPI_XFER_SIZE - off);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { .fd = client_fd, .events = POLLOUT };
+                if (poll(&pfd, 1, 100) > 0) {
+                    continue;
+                }
+            }
+            fprintf(stderr, "SPI sim: MISO write failed: %s\n", strerror(errno));
+            return -1;
+        }
+        off += written;
+    }
+    return 0;
+}
+
+// Complete one transaction: hold the bus for the modeled clock time, return
+// the queued MISO buffer, decode MOSI and queue the next MISO buffer
+static int spi_sim_transaction(void) {
+    int64_t start = (mosi_start_us > bus_free_us) ? mosi_start_us : bus_free_us;
+    int64_t end = start + xfer_time_us;
+    int64_t now = spi_sim_now_us();
+    if (end > now) {
+        usleep((useconds_t)(end - now));
+    }
+    bus_free_us = end;
+    transactions++;
+
+    uint8_t *miso = miso_bufs[miso_head];
+    if (spi_sim_write_miso(miso) != 0) {
+        spi_sim_disconnect();
+        return -1;
+    }
+
+    int processed = comm_link_rx_feed(mosi_buf, COMM_SPI_XFER_SIZE);
+    mosi_len = 0;
+
+    // Refill the slot just clocked out; it goes to the back of the queue
+    size_t n = comm_link_tx_pull(miso, COMM_SPI_XFER_SIZE);
+    memset(miso + n, 0, COMM_SPI_XFER_SIZE - n);
+    miso_head = (miso_head + 1) % COMM_SPI_QUEUE_DEPTH;
+
+    return processed;
+}
+
+static int spi_sim_init(void) {
+    if (sim_running) {
+        return 0;
+    }
+
+    if (comm_wake_open(&wake) != 0) {
+        return -1;
+    }
+
+    server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd == -1) {
+        fprintf(stderr, "SPI sim: failed to create socket: %s\n", strerror(errno));
+        comm_wake_close(&wake);
+        return -1;
+    }
+
+    unlink(COMM_SPI_SIM_PATH);
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, COMM_SPI_SIM_PATH, sizeof(addr.sun_path) - 1);
+
+    if (bind(server_fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 ||
+        listen(server_fd, 1) == -1) {
+        fprintf(stderr, "SPI sim: failed to listen on %s: %s\n", COMM_SPI_SIM_PATH, strerror(errno));
+        close(server_fd);
+        server_fd = -1;
+        comm_wake_close(&wake);
+        return -1;
+    }
+
+    int flags = fcntl(server_fd, F_GETFL, 0);
+    fcntl(server_fd, F_SETFL, flags | O_NONBLOCK);
+
+    xfer_time_us = (int64_t)COMM_SPI_XFER_SIZE * 8 * 1000000 / COMM_SPI_SIM_CLOCK_HZ;
+    comm_link_init(NULL);
+    spi_sim_reset();
+
+    sim_running = 1;
+    printf("SPI sim listening on %s (xfer=%d bytes, queue=%d, sclk=%d Hz, %lld us/xfer)\n",
+           COMM_SPI_SIM_PATH, COMM_SPI_XFER_SIZE, COMM_SPI_QUEUE_DEPTH,
+           COMM_SPI_SIM_CLOCK_HZ, (long long)xfer_time_us);
+    return 0;
+}
+
+static int spi_sim_process(void) {
+    if (!sim_running) {
+        return 0;
+    }
+
+    spi_sim_accept();
+    if (client_fd == -1) {
+        return 0;
+    }
+
+    ssize_t bytes_read = read(client_fd, mosi_buf + mosi_len, COMM_SPI_XFER_SIZE - mosi_len);
+    if (bytes_read <= 0) {
+        if (bytes_read == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            spi_sim_disconnect();
+        }
+        return -1;
+    }
+
+    if (mosi_len == 0) {
+        // Chip select asserted
+        mosi_start_us = spi_sim_now_us();
+    }
+    mosi_len += bytes_read;
+
+    if (mosi_len < COMM_SPI_XFER_SIZE) {
+        return 0;
+    }
+    return spi_sim_transaction();
+}
+
+static int spi_sim_wait(int timeout_ms) {
+    if (!sim_running) {
+        return -1;
+    }
+
+    return comm_wake_poll(&wake, (client_fd != -1) ? client_fd : server_fd, timeout_ms);
+}
+
+static void spi_sim_wakeup(void) {
+    comm_wake_signal(&wake);
+}
+
+static int spi_sim_send(const uint8_t *data, size_t len) {
+    // Responses are generated by the link layer
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+static int spi_sim_receive(uint8_t *buf, size_t buf_size) {
+    // MOSI data is decoded internally via process()
+    (void)buf;
+    (void)buf_size;
+    return 0;
+}
+
+static int spi_sim_is_running(void) {
+    return sim_running;
+}
+
+static void spi_sim_cleanup(void) {
+    if (client_fd != -1) {
+        close(client_fd);
+        client_fd = -1;
+    }
+
+    if (server_fd != -1) {
+        close(server_fd);
+        server_fd = -1;
+        unlink(COMM_SPI_SIM_PATH);
+    }
+
+    comm_link_cleanup();
+    comm_wake_close(&wake);
+    sim_running = 0;
+    printf("SPI sim stopped\n");
+}
+
+static const comm_interface_t spi_sim_comm = {
+    .init = spi_sim_init,
+    .send = spi_sim_send,
+    .receive = spi_sim_receive,
+    .process = spi_sim_process,
+    .wait = spi_sim_wait,
+    .wakeup = spi_sim_wakeup,
+    .send_ack = comm_link_send_ack,
+    .is_running = spi_sim_is_running,
+    .cleanup = spi_sim_cleanup,
+};
+
+const comm_interface_t* comm_spi_sim_get_interface(void) {
+    return &spi_sim_comm;
+}
+
+#endif // CONFIG_IDF_TARGET_LINUX
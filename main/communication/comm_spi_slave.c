@@ -10,6 +10,8 @@
 #include "driver/spi_slave.h"
 #include "driver/gpio.h"
 #include "esp_heap_caps.h"
+#include "comm_spi.h"
+#include "comm_link.h"
 
 // SPI Slave pin configuration - must match master's configuration
 #define SPI_HOST_ID      SPI2_HOST
@@ -18,20 +20,16 @@
 #define PIN_NUM_CLK      19
 #define PIN_NUM_CS       22
 
-// Fixed frame size - MUST match Master
-#define SPI_FRAME_SIZE   64
+// Transaction size and queue depth - MUST match Master (see comm_spi.h)
+#define SPI_FRAME_SIZE   COMM_SPI_XFER_SIZE
+#define NUM_BUFFERS      COMM_SPI_QUEUE_DEPTH
 
-// Double buffering for continuous operation
-#define NUM_BUFFERS      2
-
-// DMA-capable buffers (dynamically allocated)
-static uint8_t *rx_buffers[NUM_BUFFERS] = {NULL, NULL};
-static uint8_t *tx_buffers[NUM_BUFFERS] = {NULL, NULL};
+// DMA-capable buffers (dynamically allocated), one pair per queued transaction
+static uint8_t *rx_buffers[NUM_BUFFERS];
+static uint8_t *tx_buffers[NUM_BUFFERS];
 static spi_slave_transaction_t transactions[NUM_BUFFERS];
-static int current_buf = 0;
 
 static int spi_running = 0;
-static SemaphoreHandle_t spi_mutex = NULL;
 static SemaphoreHandle_t trans_ready_sem = NULL;
 
 // Callback called after a transaction is done (ISR context)
@@ -50,12 +48,14 @@ static void IRAM_ATTR spi_post_setup_cb(spi_slave_transaction_t *trans)
     // Transaction is queued and ready
 }
 
-// Queue next transaction to keep slave always ready
-static esp_err_t queue_next_transaction(void)
+// (Re)queue a transaction. Its MISO data is fixed now, so pending responses
+// are pulled from the link layer and the rest is padded with 0x00.
+static esp_err_t queue_transaction(int buf_idx)
 {
-    int buf_idx = current_buf;
+    size_t n = comm_link_tx_pull(tx_buffers[buf_idx], SPI_FRAME_SIZE);
+    memset(tx_buffers[buf_idx] + n, 0, SPI_FRAME_SIZE - n);
 
-    transactions[buf_idx].length = SPI_FRAME_SIZE * 8;  // Length in bits
+    transactions[buf_idx].length = SPI_FRAME_SIZE * 8;  // Maximum length in bits
     transactions[buf_idx].tx_buffer = tx_buffers[buf_idx];
     transactions[buf_idx].rx_buffer = rx_buffers[buf_idx];
 
@@ -67,7 +67,7 @@ static int spi_init(void) {
         return 0;
     }
 
-    // Allocate DMA-capable buffers (double buffered)
+    // Allocate DMA-capable buffers (one pair per queued transaction)
     for (int i = 0; i < NUM_BUFFERS; i++) {
         rx_buffers[i] = (uint8_t *)heap_caps_malloc(SPI_FRAME_SIZE, MALLOC_CAP_DMA);
         tx_buffers[i] = (uint8_t *)heap_caps_malloc(SPI_FRAME_SIZE, MALLOC_CAP_DMA);
@@ -79,20 +79,13 @@ static int spi_init(void) {
         memset(tx_buffers[i], 0, SPI_FRAME_SIZE);
         memset(&transactions[i], 0, sizeof(spi_slave_transaction_t));
     }
-    printf("SPI: DMA buffers allocated (frame_size=%d, double_buffered)\n", SPI_FRAME_SIZE);
-
-    // Create mutex for thread safety
-    spi_mutex = xSemaphoreCreateMutex();
-    if (!spi_mutex) {
-        printf("SPI: Failed to create mutex\n");
-        goto cleanup_buffers;
-    }
+    printf("SPI: DMA buffers allocated (frame_size=%d, queue_depth=%d)\n", SPI_FRAME_SIZE, NUM_BUFFERS);
 
-    // Create binary semaphore for transaction complete signaling
-    trans_ready_sem = xSemaphoreCreateBinary();
+    // Counting semaphore: one count per completed transaction
+    trans_ready_sem = xSemaphoreCreateCounting(NUM_BUFFERS, 0);
     if (!trans_ready_sem) {
         printf("SPI: Failed to create semaphore\n");
-        goto cleanup_mutex;
+        goto cleanup_buffers;
     }
 
     // Configure SPI bus for slave mode
@@ -109,7 +102,7 @@ static int spi_init(void) {
     spi_slave_interface_config_t slvcfg = {
         .mode = 0,  // SPI mode 0 (CPOL=0, CPHA=0)
         .spics_io_num = PIN_NUM_CS,
-        .queue_size = NUM_BUFFERS,  // Match buffer count
+        .queue_size = NUM_BUFFERS,  // Keep every buffer queued to the DMA
         .flags = 0,
         .post_setup_cb = spi_post_setup_cb,
         .post_trans_cb = spi_post_trans_cb,
@@ -128,15 +121,15 @@ static int spi_init(void) {
         goto cleanup_sem;
     }
 
+    comm_link_init(NULL);
+
     // Pre-queue transactions to be always ready
     for (int i = 0; i < NUM_BUFFERS; i++) {
-        current_buf = i;
-        ret = queue_next_transaction();
+        ret = queue_transaction(i);
         if (ret != ESP_OK) {
             printf("SPI: Failed to queue initial transaction %d: %d\n", i, ret);
         }
     }
-    current_buf = 0;
 
     spi_running = 1;
     printf("SPI slave initialized - MOSI:%d MISO:%d CLK:%d CS:%d (frame=%d bytes)\n",
@@ -146,9 +139,6 @@ static int spi_init(void) {
 cleanup_sem:
     vSemaphoreDelete(trans_ready_sem);
     trans_ready_sem = NULL;
-cleanup_mutex:
-    vSemaphoreDelete(spi_mutex);
-    spi_mutex = NULL;
 cleanup_buffers:
     for (int i = 0; i < NUM_BUFFERS; i++) {
         if (rx_buffers[i]) heap_caps_free(rx_buffers[i]);
@@ -160,40 +150,32 @@ cleanup_buffers:
 }
 
 static int spi_send(const uint8_t *data, size_t len) {
-    if (!spi_running || !data || len == 0) {
-        return -1;
-    }
+    // Responses are generated by the link layer
+    (void)data;
+    (void)len;
+    return 0;
+}
 
-    if (len > SPI_FRAME_SIZE) {
-        len = SPI_FRAME_SIZE;
-    }
+static int spi_receive(uint8_t *buf, size_t buf_size) {
+    // MOSI data is decoded internally via process()
+    (void)buf;
+    (void)buf_size;
+    return 0;
+}
 
-    if (xSemaphoreTake(spi_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+static int spi_wait(int timeout_ms) {
+    if (!spi_running) {
         return -1;
     }
 
-    // Copy data to current TX buffer
-    memcpy(tx_buffers[current_buf], data, len);
-
-    xSemaphoreGive(spi_mutex);
-    return len;
+    // Wait for transaction complete (signaled from ISR)
+    return (xSemaphoreTake(trans_ready_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE) ? 1 : 0;
 }
 
-static int spi_receive(uint8_t *buf, size_t buf_size) {
-    if (!spi_running || !buf || buf_size == 0) {
-        return 0;
-    }
-
-    if (xSemaphoreTake(spi_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return 0;
+static void spi_wakeup(void) {
+    if (trans_ready_sem) {
+        xSemaphoreGive(trans_ready_sem);
     }
-
-    // Copy received data from current RX buffer
-    size_t copy_len = (buf_size < SPI_FRAME_SIZE) ? buf_size : SPI_FRAME_SIZE;
-    memcpy(buf, rx_buffers[current_buf], copy_len);
-
-    xSemaphoreGive(spi_mutex);
-    return copy_len;
 }
 
 static int spi_process(void) {
@@ -201,80 +183,26 @@ static int spi_process(void) {
         return 0;
     }
 
-    // Wait for transaction complete (signaled from ISR)
-    if (xSemaphoreTake(trans_ready_sem, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return 0;  // Timeout - no transaction
-    }
-
-    // Get the completed transaction
+    // Drain every completed transaction; spi_wait() may have consumed only one count
+    int processed = 0;
     spi_slave_transaction_t *completed_trans;
-    esp_err_t ret = spi_slave_get_trans_result(SPI_HOST_ID, &completed_trans, 0);
+    while (spi_slave_get_trans_result(SPI_HOST_ID, &completed_trans, 0) == ESP_OK) {
+        int buf_idx = (int)(completed_trans - transactions);
+        size_t rx_len = completed_trans->trans_len / 8;
 
-    if (ret != ESP_OK) {
-        return 0;
-    }
-
-    size_t rx_len = completed_trans->trans_len / 8;
-
-    if (rx_len > 0) {
-        // Find which buffer was used
-        int buf_idx = (completed_trans->rx_buffer == rx_buffers[0]) ? 0 : 1;
-
-        printf("SPI Slave[%d]: Received %d bytes: ", buf_idx, (int)rx_len);
-        for (int i = 0; i < rx_len && i < 16; i++) {
-            printf("%02X ", ((uint8_t*)completed_trans->rx_buffer)[i]);
-        }
-        printf("\n");
-
-        // Prepare response in this buffer for next transaction
-        if (xSemaphoreTake(spi_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            uint8_t *tx_buf = tx_buffers[buf_idx];
-            uint8_t *rx_buf = rx_buffers[buf_idx];
-
-            tx_buf[0] = 0xAC;  // ACK marker
-            tx_buf[1] = 0x00;  // Status OK
-            // Echo back received data
-            for (int i = 0; i < (int)rx_len && i < SPI_FRAME_SIZE - 2; i++) {
-                tx_buf[i + 2] = rx_buf[i];
-            }
-            xSemaphoreGive(spi_mutex);
+        // MOSI bytes continue the COBS stream; 0x00 padding is skipped by the decoder
+        if (rx_len > 0) {
+            processed += comm_link_rx_feed(rx_buffers[buf_idx], rx_len);
         }
 
-        // Re-queue this buffer for next transaction
-        current_buf = buf_idx;
-        queue_next_transaction();
-
-        return 1;  // Processed one transaction
-    }
-
-    // Re-queue even if no data
-    queue_next_transaction();
-    return 0;
-}
-
-static int spi_send_ack(uint8_t type, uint8_t seq, const uint8_t *response_data, uint16_t response_len) {
-    if (!spi_running) {
-        return -1;
-    }
-
-    if (xSemaphoreTake(spi_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return -1;
-    }
-
-    uint8_t *tx_buf = tx_buffers[current_buf];
-    tx_buf[0] = 0xAC;  // ACK marker
-    tx_buf[1] = type;
-    tx_buf[2] = seq;
-
-    if (response_data && response_len > 0) {
-        size_t copy_len = (response_len < SPI_FRAME_SIZE - 3) ? response_len : SPI_FRAME_SIZE - 3;
-        memcpy(&tx_buf[3], response_data, copy_len);
+        // Re-queue this buffer; it carries the responses produced so far
+        esp_err_t ret = queue_transaction(buf_idx);
+        if (ret != ESP_OK) {
+            printf("SPI: Failed to re-queue transaction %d: %d\n", buf_idx, ret);
+        }
     }
 
-    xSemaphoreGive(spi_mutex);
-
-    printf("SPI ACK prepared: type=%u seq=%u len=%u\n", type, seq, response_len);
-    return 0;
+    return processed;
 }
 
 static int spi_is_running(void) {
@@ -286,11 +214,6 @@ static void spi_cleanup(void) {
         spi_slave_free(SPI_HOST_ID);
     }
 
-    if (spi_mutex) {
-        vSemaphoreDelete(spi_mutex);
-        spi_mutex = NULL;
-    }
-
     if (trans_ready_sem) {
         vSemaphoreDelete(trans_ready_sem);
         trans_ready_sem = NULL;
@@ -308,6 +231,7 @@ static void spi_cleanup(void) {
         }
     }
 
+    comm_link_cleanup();
     spi_running = 0;
     printf("SPI slave communication stopped\n");
 }
@@ -317,7 +241,9 @@ static const comm_interface_t spi_comm = {
     .send = spi_send,
     .receive = spi_receive,
     .process = spi_process,
-    .send_ack = spi_send_ack,
+    .wait = spi_wait,
+    .wakeup = spi_wakeup,
+    .send_ack = comm_link_send_ack,
     .is_running = spi_is_running,
     .cleanup = spi_cleanup,
 };
@@ -0,0 +1,71 @@
+#include "comm_wake.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+
+int comm_wake_open(comm_wake_t *wake) {
+    if (pipe(wake->fds) == -1) {
+        fprintf(stderr, "Failed to create wake-up pipe: %s\n", strerror(errno));
+        wake->fds[0] = wake->fds[1] = -1;
+        return -1;
+    }
+
+    // Both ends non-blocking: signalling never blocks, draining stops at empty
+    for (int i = 0; i < 2; i++) {
+        int flags = fcntl(wake->fds[i], F_GETFL, 0);
+        fcntl(wake->fds[i], F_SETFL, flags | O_NONBLOCK);
+        fcntl(wake->fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    return 0;
+}
+
+void comm_wake_close(comm_wake_t *wake) {
+    for (int i = 0; i < 2; i++) {
+        if (wake->fds[i] != -1) {
+            close(wake->fds[i]);
+            wake->fds[i] = -1;
+        }
+    }
+}
+
+int comm_wake_poll(comm_wake_t *wake, int fd, int timeout_ms) {
+    struct pollfd fds[2];
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = wake->fds[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+
+    int ret = poll(fds, 2, timeout_ms);
+    if (ret < 0) {
+        // Signals (including the scheduler tick on the POSIX port) interrupt poll()
+        if (errno == EINTR) {
+            return 0;
+        }
+        fprintf(stderr, "poll error: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (fds[1].revents & POLLIN) {
+        uint8_t drain[16];
+        while (read(wake->fds[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+
+    // POLLHUP/POLLERR are left to the caller: read() reports the disconnect
+    return (fds[0].revents != 0) ? 1 : 0;
+}
+
+void comm_wake_signal(comm_wake_t *wake) {
+    if (wake->fds[1] != -1) {
+        uint8_t b = 1;
+        // EAGAIN (pipe full) means a wake-up is already pending
+        ssize_t n = write(wake->fds[1], &b, 1);
+        (void)n;
+    }
+}
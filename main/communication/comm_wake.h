@@ -0,0 +1,53 @@
+#ifndef COMM_WAKE_H
+#define COMM_WAKE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Wake-up pipe for the Linux transports
+ *
+ * A transport's wait() polls its socket together with the read end of a
+ * self-pipe; wakeup() writes one byte to the other end, so a pending wait()
+ * returns early (e.g. on shutdown). Both ends are non-blocking.
+ */
+typedef struct {
+    int fds[2];  // -1 when closed
+} comm_wake_t;
+
+#define COMM_WAKE_INIT { { -1, -1 } }
+
+/**
+ * @brief Create the pipe
+ * @param wake Wake-up pipe
+ * @return 0 on success, -1 on error
+ */
+int comm_wake_open(comm_wake_t *wake);
+
+/**
+ * @brief Close the pipe (safe to call when not open)
+ * @param wake Wake-up pipe
+ */
+void comm_wake_close(comm_wake_t *wake);
+
+/**
+ * @brief Wait until fd is readable or comm_wake_signal() is called
+ * @param wake Wake-up pipe
+ * @param fd File descriptor to poll for input
+ * @param timeout_ms Maximum time to wait in milliseconds (-1 waits forever)
+ * @return 1 if fd has events, 0 on timeout, wake-up or EINTR, -1 on error
+ */
+int comm_wake_poll(comm_wake_t *wake, int fd, int timeout_ms);
+
+/**
+ * @brief Interrupt a pending comm_wake_poll() (async-signal-safe)
+ * @param wake Wake-up pipe
+ */
+void comm_wake_signal(comm_wake_t *wake);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMM_WAKE_H
@@ -0,0 +1,141 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+extern "C" {
+#include "glyph_atlas.h"
+#include "fmrb_blit8.h"
+}
+
+#define GLYPH_FIRST     0x20
+#define GLYPH_COUNT     (0x7F - GLYPH_FIRST)
+#define GLYPH_LINE_MAX  2048   // Longest run in pixels
+
+typedef struct {
+    int32_t height;
+    uint8_t advance[GLYPH_COUNT];
+    uint32_t offset[GLYPH_COUNT];  // Into masks; advance * height bytes per glyph, row-major
+    uint8_t* masks;
+} glyph_atlas_t;
+
+static glyph_atlas_t g_atlas;
+
+extern "C" int glyph_atlas_init(void) {
+    if (g_atlas.masks) {
+        return 0;
+    }
+
+    // A fresh sprite uses the same default font and text size as the canvases
+    LGFX_Sprite sprite;
+    sprite.setColorDepth(8);
+
+    int32_t height = sprite.fontHeight();
+    int32_t max_advance = 0;
+    size_t total = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        char str[2] = { (char)(GLYPH_FIRST + i), '\0' };
+        int32_t advance = sprite.textWidth(str);
+        if (advance <= 0 || advance > 255) {
+            fprintf(stderr, "Glyph atlas: unexpected advance %d for 0x%02x\n", (int)advance, GLYPH_FIRST + i);
+            return -1;
+        }
+        g_atlas.advance[i] = (uint8_t)advance;
+        g_atlas.offset[i] = (uint32_t)total;
+        total += (size_t)advance * height;
+        max_advance = std::max(max_advance, advance);
+    }
+
+    uint8_t* masks = (uint8_t*)malloc(total);
+    if (!masks || !sprite.createSprite(max_advance, height)) {
+        fprintf(stderr, "Glyph atlas: failed to allocate %u bytes\n", (unsigned)total);
+        free(masks);
+        return -1;
+    }
+
+    // Rasterise each glyph in white on black and keep it as a 0x00/0xFF mask
+    const uint8_t* pixels = (const uint8_t*)sprite.getBuffer();
+    sprite.setTextColor((uint8_t)0xFF);
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        char str[2] = { (char)(GLYPH_FIRST + i), '\0' };
+        sprite.fillScreen((uint8_t)0x00);
+        sprite.setCursor(0, 0);
+        sprite.print(str);
+
+        uint8_t* mask = masks + g_atlas.offset[i];
+        for (int32_t row = 0; row < height; row++) {
+            for (int32_t col = 0; col < g_atlas.advance[i]; col++) {
+                *mask++ = pixels[row * max_advance + col] ? 0xFF : 0x00;
+            }
+        }
+    }
+    sprite.deleteSprite();
+
+    g_atlas.height = height;
+    g_atlas.masks = masks;
+    return 0;
+}
+
+extern "C" void glyph_atlas_cleanup(void) {
+    free(g_atlas.masks);
+    g_atlas.masks = NULL;
+    g_atlas.height = 0;
+}
+
+extern "C" int32_t glyph_atlas_height(void) {
+    return g_atlas.height;
+}
+
+extern "C" int glyph_atlas_draw(uint8_t *dst, size_t stride, int32_t dst_w, int32_t dst_h, int32_t x, int32_t y,
+                                const char *text, size_t len, uint8_t fg, int16_t bg, int32_t *width) {
+    if (!g_atlas.masks) {
+        return -1;
+    }
+
+    int32_t run_w = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = (uint8_t)text[i];
+        if (c < GLYPH_FIRST || c >= GLYPH_FIRST + GLYPH_COUNT) {
+            return -1;
+        }
+        run_w += g_atlas.advance[c - GLYPH_FIRST];
+    }
+    if (run_w > GLYPH_LINE_MAX || x + run_w > dst_w) {
+        return -1;
+    }
+    if (width) {
+        *width = run_w;
+    }
+
+    int32_t x0 = std::max(x, (int32_t)0);
+    int32_t x1 = x + run_w;
+    int32_t y0 = std::max(y, (int32_t)0);
+    int32_t y1 = std::min(y + g_atlas.height, dst_h);
+    if (x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+
+    // One scanline of the run at a time: concatenate the glyph rows, then blend
+    uint8_t line[GLYPH_LINE_MAX];
+    for (int32_t py = y0; py < y1; py++) {
+        int32_t row = py - y;
+        uint8_t* p = line;
+        for (size_t i = 0; i < len; i++) {
+            int g = (uint8_t)text[i] - GLYPH_FIRST;
+            uint8_t advance = g_atlas.advance[g];
+            memcpy(p, g_atlas.masks + g_atlas.offset[g] + row * advance, advance);
+            p += advance;
+        }
+
+        uint8_t* out = dst + py * stride + x0;
+        if (bg >= 0) {
+            fmrb_blit8_mask_row_opaque(out, line + (x0 - x), x1 - x0, fg, (uint8_t)bg);
+        } else {
+            fmrb_blit8_mask_row(out, line + (x0 - x), x1 - x0, fg);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Glyph atlas for text runs on RGB332 buffers
+ *
+ * The printable ASCII glyphs (0x20-0x7E) of the default LovyanGFX font are
+ * rasterised once into 8-bit masks (0x00/0xFF, one cell of advance x font
+ * height per glyph). A text run is drawn a scanline at a time: the glyph mask
+ * rows of the whole run are concatenated into a line and blended into the
+ * destination with word-wide writes (fmrb_blit8_mask_row*).
+ *
+ * Not thread-safe: used by the graphics task only.
+ */
+
+/**
+ * @brief Rasterise the atlas (does nothing if it is already built)
+ * @return 0 on success, -1 on failure
+ */
+int glyph_atlas_init(void);
+
+/**
+ * @brief Free the atlas
+ */
+void glyph_atlas_cleanup(void);
+
+/**
+ * @brief Font height of the atlas in pixels (0 if not built)
+ */
+int32_t glyph_atlas_height(void);
+
+/**
+ * @brief Draw a single-line text run into an RGB332 buffer
+ *
+ * Runs that LovyanGFX would draw differently are rejected so the caller can
+ * fall back to print(): characters outside 0x20-0x7E, or a run that does not
+ * fit in the buffer width from x (print() would wrap it).
+ *
+ * @param dst Buffer (top-left pixel)
+ * @param stride Buffer row stride in bytes
+ * @param dst_w Buffer width (clip)
+ * @param dst_h Buffer height (clip)
+ * @param x Left of the run
+ * @param y Top of the run
+ * @param text Characters (not NUL-terminated)
+ * @param len Number of characters
+ * @param fg Text colour (RGB332)
+ * @param bg Background colour (RGB332), or -1 for a transparent background
+ * @param width Output run width in pixels, may be NULL
+ * @return 0 if drawn, -1 if the run must be drawn with print()
+ */
+int glyph_atlas_draw(uint8_t *dst, size_t stride, int32_t dst_w, int32_t dst_h, int32_t x, int32_t y,
+                     const char *text, size_t len, uint8_t fg, int16_t bg, int32_t *width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GLYPH_ATLAS_H
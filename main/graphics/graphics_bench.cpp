@@ -0,0 +1,172 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+extern "C" {
+#include "graphics_bench.h"
+#include "fmrb_blit8.h"
+#include "fmrb_link_bench.h"  // fmrb_link_bench_now_us()
+#include "glyph_atlas.h"
+}
+
+#define BENCH_WIDTH   480
+#define BENCH_HEIGHT  320
+#ifdef CONFIG_IDF_TARGET_LINUX
+#define BENCH_FRAMES  500
+#else
+#define BENCH_FRAMES  20
+#endif
+#define BENCH_KEY     0xE3  // Magenta (RGB332)
+#ifdef CONFIG_IDF_TARGET_LINUX
+#define BENCH_TEXT_RUNS 20000
+#else
+#define BENCH_TEXT_RUNS 500
+#endif
+
+static double bench_frame_us(int64_t start) {
+    int64_t elapsed = fmrb_link_bench_now_us() - start;
+    return (double)elapsed / BENCH_FRAMES;
+}
+
+extern "C" void graphics_bench_blit(void) {
+    size_t size = (size_t)BENCH_WIDTH * BENCH_HEIGHT;
+    uint8_t* src_mem = (uint8_t*)malloc(size);
+    uint8_t* dst_mem = (uint8_t*)malloc(size);
+    if (!src_mem || !dst_mem) {
+        fprintf(stderr, "graphics_bench: failed to allocate buffers\n");
+        free(src_mem);
+        free(dst_mem);
+        return;
+    }
+
+    // Roughly a quarter of the source pixels are transparent
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        src_mem[i] = ((seed >> 16) & 3) == 0 ? BENCH_KEY : (uint8_t)(seed >> 24);
+    }
+
+    LGFX_Sprite src;
+    LGFX_Sprite dst;
+    src.setColorDepth(8);
+    dst.setColorDepth(8);
+    src.setBuffer(src_mem, BENCH_WIDTH, BENCH_HEIGHT, 8);
+    dst.setBuffer(dst_mem, BENCH_WIDTH, BENCH_HEIGHT, 8);
+
+    printf("Blit benchmark %dx%d RGB332, us/frame (keyed copy engine: %s)\n",
+           BENCH_WIDTH, BENCH_HEIGHT, fmrb_blit8_engine());
+
+    int64_t start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        src.pushSprite(&dst, 0, 0);
+    }
+    double sprite_copy = bench_frame_us(start);
+
+    start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        fmrb_blit8_copy(dst_mem, BENCH_WIDTH, src_mem, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT);
+    }
+    double blit_copy = bench_frame_us(start);
+
+    start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        src.pushSprite(&dst, 0, 0, (uint8_t)BENCH_KEY);
+    }
+    double sprite_key = bench_frame_us(start);
+
+    start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        fmrb_blit8_copy_key_bytewise(dst_mem, BENCH_WIDTH, src_mem, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, BENCH_KEY);
+    }
+    double bytewise_key = bench_frame_us(start);
+
+    start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        fmrb_blit8_copy_key(dst_mem, BENCH_WIDTH, src_mem, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, BENCH_KEY);
+    }
+    double blit_key = bench_frame_us(start);
+
+    start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        dst.fillRect(0, 0, BENCH_WIDTH, BENCH_HEIGHT, (uint8_t)i);
+    }
+    double sprite_fill = bench_frame_us(start);
+
+    start = fmrb_link_bench_now_us();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        fmrb_blit8_fill(dst_mem, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, (uint8_t)i);
+    }
+    double blit_fill = bench_frame_us(start);
+
+    printf("  opaque copy: pushSprite %8.1f  blit8 %8.1f\n", sprite_copy, blit_copy);
+    printf("  keyed copy:  pushSprite %8.1f  blit8 %8.1f  bytewise %8.1f\n", sprite_key, blit_key, bytewise_key);
+    printf("  fill:        fillRect   %8.1f  blit8 %8.1f\n", sprite_fill, blit_fill);
+
+    free(src_mem);
+    free(dst_mem);
+}
+
+static double bench_glyphs_per_sec(int64_t start, size_t glyphs) {
+    int64_t elapsed = fmrb_link_bench_now_us() - start;
+    if (elapsed <= 0) {
+        elapsed = 1;
+    }
+    return (double)glyphs * 1e6 / (double)elapsed;
+}
+
+extern "C" void graphics_bench_text(void) {
+    if (glyph_atlas_init() < 0) {
+        return;
+    }
+    uint8_t* mem = (uint8_t*)malloc((size_t)BENCH_WIDTH * BENCH_HEIGHT);
+    if (!mem) {
+        fprintf(stderr, "graphics_bench: failed to allocate buffer\n");
+        return;
+    }
+    LGFX_Sprite dst;
+    dst.setColorDepth(8);
+    dst.setBuffer(mem, BENCH_WIDTH, BENCH_HEIGHT, 8);
+
+    // A REPL-like line: 64 glyphs
+    static const char line[] = "irb> [1, 2, 3].map { |x| x * 2 }.sum # => 12 (Integer) abcdefghij";
+    const size_t len = 64;
+    const size_t glyphs = (size_t)BENCH_TEXT_RUNS * len;
+    char text[len + 1];
+    memcpy(text, line, len);
+    text[len] = '\0';
+    int32_t rows = BENCH_HEIGHT / glyph_atlas_height();
+
+    printf("Text benchmark %dx%d RGB332, %u-glyph runs, glyphs/s\n", BENCH_WIDTH, BENCH_HEIGHT, (unsigned)len);
+
+    double print_result[2];
+    double atlas_result[2];
+    for (int opaque = 0; opaque < 2; opaque++) {
+        if (opaque) {
+            dst.setTextColor((uint8_t)0xFF, (uint8_t)0x03);
+        } else {
+            dst.setTextColor((uint8_t)0xFF);
+        }
+        int64_t start = fmrb_link_bench_now_us();
+        for (int i = 0; i < BENCH_TEXT_RUNS; i++) {
+            dst.setCursor(0, (i % rows) * glyph_atlas_height());
+            dst.print(text);
+        }
+        print_result[opaque] = bench_glyphs_per_sec(start, glyphs);
+
+        start = fmrb_link_bench_now_us();
+        for (int i = 0; i < BENCH_TEXT_RUNS; i++) {
+            glyph_atlas_draw(mem, BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT, 0, (i % rows) * glyph_atlas_height(),
+                             text, len, 0xFF, opaque ? 0x03 : -1, NULL);
+        }
+        atlas_result[opaque] = bench_glyphs_per_sec(start, glyphs);
+    }
+
+    printf("  transparent bg: print %12.0f  atlas %12.0f\n", print_result[0], atlas_result[0]);
+    printf("  opaque bg:      print %12.0f  atlas %12.0f\n", print_result[1], atlas_result[1]);
+
+    free(mem);
+}
@@ -0,0 +1,27 @@
+#ifndef GRAPHICS_BENCH_H
+#define GRAPHICS_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Graphics microbenchmarks
+ * Results are printed to stdout. Enable the call in graphics_task.cpp to run them.
+ */
+
+/**
+ * @brief Full-screen (480x320 RGB332) blit time per frame: LGFX_Sprite::pushSprite/fillRect vs fmrb_blit8 kernels
+ */
+void graphics_bench_blit(void);
+
+/**
+ * @brief Text throughput (glyphs/s) on a 480x320 RGB332 buffer: LovyanGFX print() vs glyph atlas runs
+ */
+void graphics_bench_text(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRAPHICS_BENCH_H
@@ -1,6 +1,9 @@
 #include <cstdio>
 #include <cstring>
+#include <cstddef>
 #include <cinttypes>
+#include <cstdlib>
+#include <algorithm>
 #include <map>
 
 // Include LGFX before display_interface.h to ensure LGFX class is defined
@@ -11,9 +14,11 @@ extern "C" {
 #include "graphics_handler.h"
 #include "fmrb_link_protocol.h"
 #include "fmrb_gfx.h"
-#if defined(CONFIG_IDF_TARGET_LINUX) || defined(LGFX_USE_SDL)
-#include "socket_server.h"  // For socket_server_send_ack
-#endif
+#include "fmrb_spsc_ring.h"
+#include "fmrb_blit8.h"
+#include "fmrb_buf_pool.h"
+#include "comm_interface.h"  // For COMM_INTERFACE->send_ack
+#include "glyph_atlas.h"
 }
 
 #if defined(CONFIG_IDF_TARGET_LINUX) || defined(LGFX_USE_SDL)
@@ -22,7 +27,6 @@ extern "C" {
 #else
 // ESP32 builds - LGFX is defined in graphics_task.cpp
 // Use LovyanGFX base class instead of forward-declared LGFX
-#include "comm_interface.h"
 #include "display_interface.h"  // Includes g_lgfx declaration for ESP32
 #endif
 
@@ -46,38 +50,109 @@ extern "C" void graphics_handler_set_log_level(int level) {
 // For ESP32: defined in lgfx_wrapper.cpp
 // For Linux: defined in display_sdl2.cpp
 
+// Rectangle with exclusive x1/y1; empty when x0 >= x1 or y0 >= y1
+typedef struct {
+    int32_t x0, y0;
+    int32_t x1, y1;
+} gfx_rect_t;
+
+// canvas_state_t::present_key values other than a transparent color
+#define CANVAS_PRESENT_OPAQUE -1   // draw_buffer and render_buffer match outside `dirty`
+#define CANVAS_PRESENT_STALE  -2   // render_buffer must be fully re-copied
+
+// Tilemap layer shown by a canvas (SET_TILEMAP)
+typedef struct {
+    uint16_t image_id;           // Tile sheet in the image store
+    uint16_t tile_w, tile_h;     // Tile size in pixels
+    uint16_t map_w, map_h;       // Map size in tiles
+    int32_t scroll_x, scroll_y;  // Map pixel at the canvas top-left
+    uint16_t* tiles;             // map_w * map_h tile indices, row-major
+} tilemap_t;
+
+#define TILEMAP_MAX_CELLS  65536
+#define TILEMAP_MAX_PIXELS 65536  // Map width/height in pixels
+
 // Canvas state structure
 typedef struct {
     uint16_t canvas_id;
     LGFX_Sprite* draw_buffer;      // Drawing buffer (front buffer for user drawing)
     LGFX_Sprite* render_buffer;    // Rendering buffer (back buffer for composition)
-    void* draw_buffer_mem;         // External memory for draw_buffer
-    void* render_buffer_mem;       // External memory for render_buffer
+    void* draw_buffer_mem;         // External memory for draw_buffer (from fmrb_buf_pool)
+    void* render_buffer_mem;       // External memory for render_buffer (from fmrb_buf_pool)
+    size_t buffer_capacity;        // Usable bytes in each of the two buffers
     int16_t z_order;               // Z-order (0=bottom, higher=front, SystemApp=0 fixed)
     int16_t push_x, push_y;        // Position to push to screen
     bool is_visible;               // Visibility flag
-    uint16_t width, height;        // Canvas allocated dimensions (always max screen size)
     uint16_t active_width, active_height;  // Active drawing area (can be resized)
-    bool dirty;                    // Redraw flag
+    gfx_rect_t dirty;              // draw_buffer area changed since the last present (canvas coordinates)
+    int16_t present_key;           // Transparent color of the last present, or CANVAS_PRESENT_*
+    tilemap_t* tilemap;            // Composited instead of render_buffer when set
 } canvas_state_t;
 
+// Canvas IDs are handles: the low CANVAS_SLOT_BITS select a slot in the
+// canvas table (slot + 1, so no canvas ID is ever FMRB_CANVAS_SCREEN) and the
+// remaining bits are a per-slot generation, so a stale ID of a deleted canvas
+// never resolves to the canvas that reuses its slot.
+#define CANVAS_SLOT_BITS 6
+#define CANVAS_SLOT_MASK ((1u << CANVAS_SLOT_BITS) - 1)
+#define CANVAS_GEN_COUNT (0xFFFFu >> CANVAS_SLOT_BITS)  // Top generation excluded: it would alias FMRB_CANVAS_RENDER/INVALID
+
 // Maximum number of canvases
-#define MAX_CANVAS_COUNT 16
+#define MAX_CANVAS_COUNT CANVAS_SLOT_MASK
 
-// Screen dimensions for canvas allocation
-#define MAX_SCREEN_WIDTH 480
-#define MAX_SCREEN_HEIGHT 320
+// Largest canvas (CREATE_CANVAS/UPDATE_WINDOW), the former fixed buffer size
+#define MAX_CANVAS_WIDTH  480
+#define MAX_CANVAS_HEIGHT 320
 
-// Canvas management
+// Canvas management (graphics task). Slots never move, so canvas_state_t
+// pointers stay valid until the canvas is deleted; a free slot has canvas_id 0.
 static canvas_state_t g_canvases[MAX_CANVAS_COUNT];
 static size_t g_canvas_count = 0;
 
+// Slot indices of live canvases, bottom to top. Re-sorted only after
+// create/delete or SET_WINDOW_ORDER changed it.
+static uint8_t g_canvas_zorder[MAX_CANVAS_COUNT];
+static bool g_canvas_zorder_dirty = false;
+
+// Canvas ID allocation (comm task). Slots are handed out and released as
+// CREATE_CANVAS/DELETE_CANVAS are queued; the graphics task applies them in the
+// same order, so a slot is always free again by the time a later CREATE_CANVAS
+// reusing it is applied.
+static uint64_t g_canvas_id_used = 0;                  // Bit per slot
+static uint16_t g_canvas_id_gen[MAX_CANVAS_COUNT];     // Current generation per slot
+
+// Composition buffer: canvases are composited here in z-order and only the
+// screen area that changed since the last frame is recomposed and pushed
+static LGFX_Sprite* g_compose_buffer = nullptr;
+static void* g_compose_buffer_mem = nullptr;
+static gfx_rect_t g_screen_dirty;    // Screen area to recompose (screen coordinates)
+static gfx_rect_t g_display_dirty;   // Display area changed since the last display() call
+static gfx_compositor_t g_compositor = GFX_COMPOSITOR_AREA;
+
+// Tile-binned compositor (GFX_COMPOSITOR_TILES): the screen is split into
+// TILE_SIZE tiles, each with the visible canvases overlapping it. Only tiles
+// whose content or canvas list changed are recomposed.
+#define TILE_SIZE 32
+
+typedef struct {
+    uint8_t count;
+    uint8_t slots[MAX_CANVAS_COUNT];   // Canvas slots overlapping the tile, bottom to top
+} gfx_tile_t;
+
+static gfx_tile_t* g_tiles = nullptr;
+static uint8_t* g_tile_dirty = nullptr;  // Per tile: recompose on the next frame
+static int32_t g_tiles_x = 0;
+static int32_t g_tiles_y = 0;
+static bool g_tiles_rebin = false;       // Canvas geometry/visibility/order changed since the last binning
+
 // Cursor management
 static LGFX_Sprite* g_cursor_sprite = nullptr;
 static bool g_cursor_visible = true;
 static int g_cursor_x = 240;  // Default: screen center
 static int g_cursor_y = 135;
 static const uint32_t CURSOR_TRANSPARENT_COLOR = 0xFF00FF;  // Magenta
+static const uint8_t CURSOR_TRANSPARENT_COLOR332 = lgfx::color332(0xFF, 0x00, 0xFF);  // Same, as stored in the sprite
+#define CURSOR_SIZE 8
 
 // 8x8 arrow cursor pattern (0=transparent, 1=white outline, 2=black body)
 static const uint8_t cursor_pattern[8][8] = {
@@ -91,64 +166,353 @@ static const uint8_t cursor_pattern[8][8] = {
     {1, 1, 1, 1, 1, 1, 1, 1},
 };
 
+// Sprite table, drawn over the canvases and below the cursor
+typedef struct {
+    uint16_t image_id;
+    int16_t x, y;
+    uint8_t flags;    // FMRB_LINK_SPRITE_*
+    uint8_t priority;
+    gfx_rect_t rect;  // Screen area covered (empty when not shown)
+} gfx_sprite_t;
+
+static gfx_sprite_t g_sprites[FMRB_LINK_SPRITE_COUNT];
+static uint8_t g_sprite_order[FMRB_LINK_SPRITE_COUNT];  // Shown sprites, bottom to top
+static size_t g_sprite_order_count = 0;
+static bool g_sprite_order_dirty = false;
+static uint8_t g_sprite_key = FMRB_COLOR_MAGENTA;
+static uint8_t g_sprite_line_limit = 0;                  // Sprites per scanline (0 = unlimited)
+
+// Image store: RGB332 images uploaded once (CREATE_IMAGE_*) and drawn by ID.
+// Open-addressing table keyed by the client-chosen image ID (linear probing,
+// backward-shift deletion); pixels come from fmrb_buf_pool.
+#define IMAGE_TABLE_SIZE 128                          // Power of two
+#define MAX_IMAGE_COUNT  (IMAGE_TABLE_SIZE * 3 / 4)   // Keeps probe sequences short
+
+typedef struct {
+    uint16_t image_id;   // 0 = free entry
+    uint16_t width, height;
+    uint8_t* pixels;     // width * height bytes, row-major
+} image_entry_t;
+
+static image_entry_t g_images[IMAGE_TABLE_SIZE];
+static size_t g_image_count = 0;
+
+// Display lists: recorded drawing commands, stored as BATCH records
+// (fmrb_link_graphics_batch_item_t + structure) and replayed without decoding
+#define MAX_DISPLAY_LISTS      64
+#define DISPLAY_LIST_MAX_SIZE  (64 * 1024)  // Recorded bytes per list
+#define DISPLAY_LIST_MAX_DEPTH 8            // Nested CALL_LIST
+#define DISPLAY_LIST_MAX_REPLAY 65536       // Records replayed by one top-level CALL_LIST, nested calls included
+
+typedef struct {
+    uint16_t list_id;  // 0 = free entry / not recording
+    uint16_t count;    // Records
+    uint16_t max_len;  // Longest recorded structure
+    uint32_t size;     // Bytes used in data
+    uint8_t* data;
+} display_list_t;
+
+static display_list_t g_lists[MAX_DISPLAY_LISTS];
+static display_list_t g_list_rec;          // List being recorded
+static uint32_t g_list_rec_capacity = 0;
+static bool g_list_rec_failed = false;     // Recording overflowed: END_LIST discards it
+static uint8_t* g_list_scratch = nullptr;  // Replayed record, moved and retargeted
+static size_t g_list_scratch_size = 0;
+static int g_list_depth = 0;
+static uint16_t g_list_stack[DISPLAY_LIST_MAX_DEPTH];  // IDs of the lists being replayed (recursion check)
+static uint32_t g_list_budget = 0;                     // Records left for the current top-level CALL_LIST
+
+// Command queue: decoded commands from the comm task, applied by the graphics
+// task at a frame boundary so drawing never races with composition
+#ifdef CONFIG_IDF_TARGET_LINUX
+#define GFX_CMD_QUEUE_SIZE (256 * 1024)
+#else
+#define GFX_CMD_QUEUE_SIZE (32 * 1024)
+#endif
+#define GFX_CMD_INLINE_MAX (GFX_CMD_QUEUE_SIZE / 4)  // Larger payloads are stored out of line
+
+typedef struct {
+    uint8_t msg_type;
+    uint8_t cmd_type;
+    uint8_t seq;
+    uint8_t reserved;
+    uint32_t size;
+    uint8_t *ext_data;   // Heap copy of the payload, or NULL when it follows the record
+} gfx_cmd_record_t;
+
+static fmrb_spsc_ring_t g_cmd_ring;
+
 // Screen double buffer for compositing all canvases
 static uint16_t g_current_target = FMRB_CANVAS_SCREEN;  // 0=screen, other=canvas
 static bool g_graphics_initialized = false;  // Flag to prevent multiple initializations
 
+// Rectangle helpers
+static inline bool rect_is_empty(const gfx_rect_t* r) {
+    return r->x0 >= r->x1 || r->y0 >= r->y1;
+}
+
+static inline void rect_clear(gfx_rect_t* r) {
+    r->x0 = r->y0 = r->x1 = r->y1 = 0;
+}
+
+// Rectangle from position and size (negative sizes extend to the left/top)
+static gfx_rect_t rect_make(int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (w < 0) { x += w; w = -w; }
+    if (h < 0) { y += h; h = -h; }
+    gfx_rect_t r = { x, y, x + w, y + h };
+    return r;
+}
+
+// Rectangle covering inclusive corner points
+static gfx_rect_t rect_bounds(int32_t xmin, int32_t ymin, int32_t xmax, int32_t ymax) {
+    gfx_rect_t r = { xmin, ymin, xmax + 1, ymax + 1 };
+    return r;
+}
+
+static void rect_union(gfx_rect_t* r, const gfx_rect_t* a) {
+    if (rect_is_empty(a)) {
+        return;
+    }
+    if (rect_is_empty(r)) {
+        *r = *a;
+        return;
+    }
+    r->x0 = std::min(r->x0, a->x0);
+    r->y0 = std::min(r->y0, a->y0);
+    r->x1 = std::max(r->x1, a->x1);
+    r->y1 = std::max(r->y1, a->y1);
+}
+
+// Grow r to include pixel (x, y)
+static inline void rect_include(gfx_rect_t* r, int32_t x, int32_t y) {
+    gfx_rect_t p = { x, y, x + 1, y + 1 };
+    rect_union(r, &p);
+}
+
+// Intersect r with a; returns false when the result is empty
+static bool rect_intersect(gfx_rect_t* r, const gfx_rect_t* a) {
+    r->x0 = std::max(r->x0, a->x0);
+    r->y0 = std::max(r->y0, a->y0);
+    r->x1 = std::min(r->x1, a->x1);
+    r->y1 = std::min(r->y1, a->y1);
+    return !rect_is_empty(r);
+}
+
+// Small set of disjoint rectangles, used for occlusion culling
+#define REGION_MAX_RECTS 16
+
+typedef struct {
+    gfx_rect_t rects[REGION_MAX_RECTS];
+    int count;
+} gfx_region_t;
+
+static inline bool rect_contains(const gfx_rect_t* outer, const gfx_rect_t* inner) {
+    return inner->x0 >= outer->x0 && inner->y0 >= outer->y0 &&
+           inner->x1 <= outer->x1 && inner->y1 <= outer->y1;
+}
+
+static void region_init(gfx_region_t* rg, const gfx_rect_t* r) {
+    rg->count = 0;
+    if (!rect_is_empty(r)) {
+        rg->rects[rg->count++] = *r;
+    }
+}
+
+// Remove `cut` from the region. Each rectangle is split into up to four
+// (top, bottom, left, right); if that would overflow the region the
+// rectangle is kept whole, which only costs some overdraw.
+static void region_subtract(gfx_region_t* rg, const gfx_rect_t* cut) {
+    gfx_rect_t out[REGION_MAX_RECTS];
+    int n = 0;
+
+    for (int i = 0; i < rg->count; i++) {
+        const gfx_rect_t* a = &rg->rects[i];
+        gfx_rect_t hit = *a;
+        if (!rect_intersect(&hit, cut)) {
+            out[n++] = *a;
+            continue;
+        }
+
+        gfx_rect_t parts[4] = {
+            { a->x0, a->y0, a->x1, hit.y0 },    // Top
+            { a->x0, hit.y1, a->x1, a->y1 },    // Bottom
+            { a->x0, hit.y0, hit.x0, hit.y1 },  // Left
+            { hit.x1, hit.y0, a->x1, hit.y1 },  // Right
+        };
+        int pieces = 0;
+        for (int k = 0; k < 4; k++) {
+            pieces += rect_is_empty(&parts[k]) ? 0 : 1;
+        }
+        if (n + pieces + (rg->count - i - 1) > REGION_MAX_RECTS) {
+            out[n++] = *a;
+            continue;
+        }
+        for (int k = 0; k < 4; k++) {
+            if (!rect_is_empty(&parts[k])) {
+                out[n++] = parts[k];
+            }
+        }
+    }
+
+    memcpy(rg->rects, out, n * sizeof(gfx_rect_t));
+    rg->count = n;
+}
+
+// Add an area (screen coordinates) that must be recomposed
+static void screen_mark_dirty(gfx_rect_t r) {
+    if (!g_lgfx) {
+        return;
+    }
+    gfx_rect_t screen = { 0, 0, (int32_t)g_lgfx->width(), (int32_t)g_lgfx->height() };
+    if (!rect_intersect(&r, &screen)) {
+        return;
+    }
+    if (g_compositor == GFX_COMPOSITOR_TILES && g_tiles) {
+        int32_t tx1 = std::min((r.x1 + TILE_SIZE - 1) / TILE_SIZE, g_tiles_x);
+        int32_t ty1 = std::min((r.y1 + TILE_SIZE - 1) / TILE_SIZE, g_tiles_y);
+        for (int32_t ty = r.y0 / TILE_SIZE; ty < ty1; ty++) {
+            memset(&g_tile_dirty[ty * g_tiles_x + r.x0 / TILE_SIZE], 1, tx1 - r.x0 / TILE_SIZE);
+        }
+    } else {
+        rect_union(&g_screen_dirty, &r);
+    }
+}
+
+// Add an area of g_lgfx drawn to directly (not recomposed, only displayed)
+static void display_mark_dirty(gfx_rect_t r) {
+    if (!g_lgfx) {
+        return;
+    }
+    gfx_rect_t screen = { 0, 0, (int32_t)g_lgfx->width(), (int32_t)g_lgfx->height() };
+    if (rect_intersect(&r, &screen)) {
+        rect_union(&g_display_dirty, &r);
+    }
+}
+
 // Canvas helper functions
 static canvas_state_t* canvas_state_find(uint16_t canvas_id) {
-    for (size_t i = 0; i < g_canvas_count; i++) {
-        if (g_canvases[i].canvas_id == canvas_id) {
-            return &g_canvases[i];
-        }
+    uint32_t slot = (uint32_t)(canvas_id & CANVAS_SLOT_MASK) - 1;
+    if (slot >= MAX_CANVAS_COUNT) {
+        return nullptr;  // FMRB_CANVAS_SCREEN and other non-canvas IDs
     }
-    return nullptr;
+    canvas_state_t* canvas = &g_canvases[slot];
+    return (canvas->canvas_id == canvas_id) ? canvas : nullptr;
 }
 
-static canvas_state_t* canvas_state_alloc(uint16_t canvas_id, uint16_t req_width, uint16_t req_height) {
-    if (g_canvas_count >= MAX_CANVAS_COUNT) {
-        GFX_LOG_E("Maximum canvas count reached (%d)", MAX_CANVAS_COUNT);
-        return nullptr;
+// Screen area covered by a canvas
+static gfx_rect_t canvas_screen_rect(const canvas_state_t* canvas) {
+    return rect_make(canvas->push_x, canvas->push_y, canvas->active_width, canvas->active_height);
+}
+
+// The screen area under a visible canvas must be recomposed (shown, hidden,
+// moved, resized, restacked or deleted)
+static void canvas_mark_exposed(const canvas_state_t* canvas) {
+    if (canvas->is_visible) {
+        screen_mark_dirty(canvas_screen_rect(canvas));
+        g_tiles_rebin = true;
     }
+}
 
-    canvas_state_t* canvas = &g_canvases[g_canvas_count];
-    g_canvas_count++;
-    canvas->canvas_id = canvas_id;
+// Add an area of draw_buffer changed by a primitive (canvas coordinates)
+static void canvas_mark_dirty(canvas_state_t* canvas, gfx_rect_t r) {
+    gfx_rect_t active = { 0, 0, canvas->active_width, canvas->active_height };
+    if (rect_intersect(&r, &active)) {
+        rect_union(&canvas->dirty, &r);
+    }
+}
 
-    // Always allocate at max screen size to avoid reallocation on resize
-    canvas->width = MAX_SCREEN_WIDTH;
-    canvas->height = MAX_SCREEN_HEIGHT;
+// Record the area changed by a primitive on a canvas, or on the screen when canvas is NULL
+static void target_mark_dirty(canvas_state_t* canvas, gfx_rect_t r) {
+    if (canvas) {
+        canvas_mark_dirty(canvas, r);
+    } else {
+        display_mark_dirty(r);
+    }
+}
 
-    // Set initial active size to requested size
-    canvas->active_width = req_width;
-    canvas->active_height = req_height;
+// Make both pixel buffers hold at least width x height pixels (RGB332, 1 byte per pixel).
+// Growing keeps the bytes of the active area, like a resize within the capacity does.
+static int canvas_reserve_buffers(canvas_state_t* canvas, uint16_t width, uint16_t height) {
+    if (width > MAX_CANVAS_WIDTH || height > MAX_CANVAS_HEIGHT) {
+        GFX_LOG_E("Canvas %u: %dx%d exceeds the maximum canvas size %dx%d",
+                  canvas->canvas_id, width, height, MAX_CANVAS_WIDTH, MAX_CANVAS_HEIGHT);
+        return -1;
+    }
+    size_t size = (size_t)width * height;
+    if (canvas->draw_buffer_mem && size <= canvas->buffer_capacity) {
+        return 0;
+    }
 
-    canvas->z_order = canvas_id; // TODO: implement z_oder logic
-    canvas->push_x = 0;
-    canvas->push_y = 0;
-    canvas->is_visible = false;  // Initially invisible until first present()
-    canvas->dirty = false;
+    size_t capacity = 0;
+    void* draw_mem = fmrb_buf_pool_alloc(size, &capacity);
+    if (!draw_mem) {
+        GFX_LOG_E("Failed to allocate draw buffer memory for canvas %u (%dx%d)", canvas->canvas_id, width, height);
+        return -1;
+    }
+    void* render_mem = fmrb_buf_pool_alloc(size, nullptr);
+    if (!render_mem) {
+        GFX_LOG_E("Failed to allocate render buffer memory for canvas %u (%dx%d)", canvas->canvas_id, width, height);
+        fmrb_buf_pool_free(draw_mem);
+        return -1;
+    }
 
-    // Calculate buffer size for max screen size (RGB332 = 8bit = 1 byte per pixel)
-    size_t buffer_size = MAX_SCREEN_WIDTH * MAX_SCREEN_HEIGHT * 1;  // 1 byte per pixel for RGB332
+    if (canvas->draw_buffer_mem) {
+        size_t used = (size_t)canvas->active_width * canvas->active_height;
+        memcpy(draw_mem, canvas->draw_buffer_mem, used);
+        memcpy(render_mem, canvas->render_buffer_mem, used);
+        fmrb_buf_pool_free(canvas->draw_buffer_mem);
+        fmrb_buf_pool_free(canvas->render_buffer_mem);
+    }
+    canvas->draw_buffer_mem = draw_mem;
+    canvas->render_buffer_mem = render_mem;
+    canvas->buffer_capacity = capacity;
+    return 0;
+}
+
+static void canvas_log_pool_stats(void) {
+    fmrb_buf_pool_stats_t stats;
+    fmrb_buf_pool_get_stats(&stats);
+    GFX_LOG_I("Canvas memory: in_use=%u (requested %u) cached=%u peak=%u buffers=%u allocs=%u reuses=%u heap_allocs=%u",
+              (unsigned)stats.in_use_bytes, (unsigned)stats.requested_bytes, (unsigned)stats.cached_bytes,
+              (unsigned)stats.peak_bytes, (unsigned)stats.live_buffers, (unsigned)stats.allocs,
+              (unsigned)stats.reuses, (unsigned)stats.heap_allocs);
+}
+
+static canvas_state_t* canvas_state_alloc(uint16_t canvas_id, uint16_t req_width, uint16_t req_height, int16_t z_order) {
+    uint32_t slot = (uint32_t)(canvas_id & CANVAS_SLOT_MASK) - 1;
+    if (slot >= MAX_CANVAS_COUNT || canvas_id == FMRB_CANVAS_INVALID) {
+        GFX_LOG_E("Invalid canvas ID %u (maximum canvas count is %d)", canvas_id, MAX_CANVAS_COUNT);
+        return nullptr;
+    }
 
-    // Allocate external memory for draw buffer
-    canvas->draw_buffer_mem = malloc(buffer_size);
-    if (!canvas->draw_buffer_mem) {
-        GFX_LOG_E("Failed to allocate draw buffer memory for canvas %u", canvas_id);
-        g_canvas_count--;
+    canvas_state_t* canvas = &g_canvases[slot];
+    if (canvas->canvas_id != 0) {
+        GFX_LOG_E("Canvas slot %u already used by ID=%u", (unsigned)slot, canvas->canvas_id);
         return nullptr;
     }
 
-    // Allocate external memory for render buffer
-    canvas->render_buffer_mem = malloc(buffer_size);
-    if (!canvas->render_buffer_mem) {
-        GFX_LOG_E("Failed to allocate render buffer memory for canvas %u", canvas_id);
-        free(canvas->draw_buffer_mem);
-        g_canvas_count--;
+    // Buffers are sized to the request and only grow when UPDATE_WINDOW enlarges the canvas
+    canvas->canvas_id = canvas_id;
+    canvas->draw_buffer_mem = nullptr;
+    canvas->render_buffer_mem = nullptr;
+    canvas->buffer_capacity = 0;
+    if (canvas_reserve_buffers(canvas, req_width, req_height) < 0) {
+        canvas->canvas_id = 0;
         return nullptr;
     }
 
+    // Set initial active size to requested size
+    canvas->active_width = req_width;
+    canvas->active_height = req_height;
+
+    canvas->z_order = z_order;
+    canvas->push_x = 0;
+    canvas->push_y = 0;
+    canvas->is_visible = false;  // Initially invisible until first present()
+    rect_clear(&canvas->dirty);
+    canvas->present_key = CANVAS_PRESENT_STALE;
+    canvas->tilemap = nullptr;
+
     // Create draw buffer sprite and set external buffer
     canvas->draw_buffer = new LGFX_Sprite(g_lgfx);
     canvas->draw_buffer->setColorDepth(8);  // RGB332
@@ -159,9 +523,13 @@ static canvas_state_t* canvas_state_alloc(uint16_t canvas_id, uint16_t req_width
     canvas->render_buffer->setColorDepth(8);  // RGB332
     canvas->render_buffer->setBuffer(canvas->render_buffer_mem, req_width, req_height, 8);
 
-    GFX_LOG_I("Canvas allocated: ID=%u, allocated_size=%dx%d, active_size=%dx%d, z_order=%d",
-              canvas_id, canvas->width, canvas->height,
+    g_canvas_zorder[g_canvas_count++] = (uint8_t)slot;
+    g_canvas_zorder_dirty = true;
+
+    GFX_LOG_I("Canvas allocated: ID=%u, slot=%u, buffer_capacity=%u, active_size=%dx%d, z_order=%d",
+              canvas_id, (unsigned)slot, (unsigned)canvas->buffer_capacity,
               canvas->active_width, canvas->active_height, canvas->z_order);
+    canvas_log_pool_stats();
     return canvas;
 }
 
@@ -169,6 +537,7 @@ static void canvas_state_free(canvas_state_t* canvas) {
     if (!canvas) return;
 
     GFX_LOG_I("Freeing canvas ID=%u", canvas->canvas_id);
+    canvas_mark_exposed(canvas);
 
     if (canvas->draw_buffer) {
         delete canvas->draw_buffer;
@@ -179,165 +548,1572 @@ static void canvas_state_free(canvas_state_t* canvas) {
         canvas->render_buffer = nullptr;
     }
 
-    // Free external memory buffers
-    if (canvas->draw_buffer_mem) {
-        free(canvas->draw_buffer_mem);
-        canvas->draw_buffer_mem = nullptr;
+    free(canvas->tilemap);
+    canvas->tilemap = nullptr;
+
+    // Return the buffers to the pool for the next canvas of a similar size
+    fmrb_buf_pool_free(canvas->draw_buffer_mem);
+    canvas->draw_buffer_mem = nullptr;
+    fmrb_buf_pool_free(canvas->render_buffer_mem);
+    canvas->render_buffer_mem = nullptr;
+    canvas->buffer_capacity = 0;
+
+    // Remove from the z-order index; the remaining entries stay sorted
+    uint8_t slot = (uint8_t)(canvas - g_canvases);
+    for (size_t i = 0; i < g_canvas_count; i++) {
+        if (g_canvas_zorder[i] == slot) {
+            memmove(&g_canvas_zorder[i], &g_canvas_zorder[i + 1], g_canvas_count - i - 1);
+            g_canvas_count--;
+            break;
+        }
+    }
+    canvas->canvas_id = 0;
+    canvas_log_pool_stats();
+}
+
+static void canvas_set_zorder(canvas_state_t* canvas, int16_t z_order) {
+    if (canvas->z_order != z_order) {
+        canvas->z_order = z_order;
+        g_canvas_zorder_dirty = true;
+        if (g_compositor == GFX_COMPOSITOR_TILES) {
+            g_tiles_rebin = true;  // Only tiles whose stacking actually changed are recomposed
+        } else {
+            canvas_mark_exposed(canvas);
+        }
+    }
+}
+
+// Sort the z-order index (low to high). Insertion sort: the index is small,
+// usually only one entry moved, and equal z_order keeps creation order.
+static void canvas_sort_by_zorder() {
+    if (!g_canvas_zorder_dirty) {
+        return;
     }
-    if (canvas->render_buffer_mem) {
-        free(canvas->render_buffer_mem);
-        canvas->render_buffer_mem = nullptr;
+    for (size_t i = 1; i < g_canvas_count; i++) {
+        uint8_t slot = g_canvas_zorder[i];
+        int16_t z = g_canvases[slot].z_order;
+        size_t j = i;
+        while (j > 0 && g_canvases[g_canvas_zorder[j - 1]].z_order > z) {
+            g_canvas_zorder[j] = g_canvas_zorder[j - 1];
+            j--;
+        }
+        g_canvas_zorder[j] = slot;
     }
+    g_canvas_zorder_dirty = false;
+}
 
-    // Remove from array by shifting remaining elements
-    size_t index = canvas - g_canvases;
-    if (index < g_canvas_count - 1) {
-        memmove(&g_canvases[index], &g_canvases[index + 1],
-                (g_canvas_count - index - 1) * sizeof(canvas_state_t));
+// Copy rectangle r (canvas coordinates, clipped to the canvas) between two canvas-sized buffers
+static void canvas_copy_rect(const canvas_state_t* canvas, void* dst_mem, const void* src_mem,
+                             const gfx_rect_t* r, int16_t key) {
+    size_t stride = canvas->active_width;
+    size_t offset = r->y0 * stride + r->x0;
+    uint8_t* dst = (uint8_t*)dst_mem + offset;
+    const uint8_t* src = (const uint8_t*)src_mem + offset;
+    if (key >= 0) {
+        fmrb_blit8_copy_key(dst, stride, src, stride, r->x1 - r->x0, r->y1 - r->y0, (uint8_t)key);
+    } else {
+        fmrb_blit8_copy(dst, stride, src, stride, r->x1 - r->x0, r->y1 - r->y0);
     }
-    g_canvas_count--;
 }
 
-// Compare function for qsort (sort by z_order ascending)
-static int canvas_compare_zorder(const void* a, const void* b) {
-    const canvas_state_t* ca = (const canvas_state_t*)a;
-    const canvas_state_t* cb = (const canvas_state_t*)b;
-    return ca->z_order - cb->z_order;
+// Fill rectangle r of the composition buffer with the background color
+static void compose_fill(const gfx_rect_t* r) {
+    size_t stride = g_compose_buffer->width();
+    fmrb_blit8_fill((uint8_t*)g_compose_buffer_mem + r->y0 * stride + r->x0, stride,
+                    r->x1 - r->x0, r->y1 - r->y0, FMRB_COLOR_BLACK);
 }
 
-static void canvas_sort_by_zorder() {
-    if (g_canvas_count > 1) {
-        qsort(g_canvases, g_canvas_count, sizeof(canvas_state_t), canvas_compare_zorder);
+static image_entry_t* image_find(uint16_t image_id);
+
+// Render the tilemap of a canvas at screen rectangle r: one span per tile per scanline
+static void compose_tilemap(const canvas_state_t* canvas, const gfx_rect_t* r) {
+    const tilemap_t* tm = canvas->tilemap;
+    size_t stride = g_compose_buffer->width();
+    uint8_t* dst_row = (uint8_t*)g_compose_buffer_mem + r->y0 * stride + r->x0;
+    int32_t w = r->x1 - r->x0;
+
+    const image_entry_t* sheet = image_find(tm->image_id);
+    if (!sheet || sheet->width < tm->tile_w || sheet->height < tm->tile_h) {
+        fmrb_blit8_fill(dst_row, stride, w, r->y1 - r->y0, FMRB_COLOR_BLACK);
+        return;
+    }
+    uint32_t sheet_cols = sheet->width / tm->tile_w;
+    uint32_t tile_count = sheet_cols * (sheet->height / tm->tile_h);
+
+    // Map coordinates wrap around (map size capped by tilemap_set, the scroll
+    // offset is any int32_t, so the sum is formed in 64 bits)
+    int32_t map_px_w = (int32_t)tm->map_w * tm->tile_w;
+    int32_t map_px_h = (int32_t)tm->map_h * tm->tile_h;
+    int32_t mx0 = (int32_t)(((int64_t)r->x0 - canvas->push_x + tm->scroll_x) % map_px_w);
+    int32_t my = (int32_t)(((int64_t)r->y0 - canvas->push_y + tm->scroll_y) % map_px_h);
+    if (mx0 < 0) mx0 += map_px_w;
+    if (my < 0) my += map_px_h;
+
+    for (int32_t y = r->y0; y < r->y1; y++, dst_row += stride) {
+        const uint16_t* map_row = tm->tiles + (my / tm->tile_h) * tm->map_w;
+        int32_t ty = my % tm->tile_h;
+        uint8_t* dst = dst_row;
+        int32_t mx = mx0;
+        for (int32_t left = w; left > 0; ) {
+            int32_t tx = mx % tm->tile_w;
+            int32_t span = std::min((int32_t)tm->tile_w - tx, left);
+            uint16_t tile = map_row[mx / tm->tile_w];
+            if (tile < tile_count) {
+                const uint8_t* src = sheet->pixels +
+                                     ((tile / sheet_cols) * tm->tile_h + ty) * sheet->width +
+                                     (tile % sheet_cols) * tm->tile_w + tx;
+                memcpy(dst, src, span);
+            } else {
+                memset(dst, FMRB_COLOR_BLACK, span);
+            }
+            dst += span;
+            left -= span;
+            mx += span;
+            if (mx == map_px_w) {
+                mx = 0;
+            }
+        }
+        if (++my == map_px_h) {
+            my = 0;
+        }
     }
 }
 
-// Render all canvases to screen in Z-order
-static void graphics_handler_render_frame_internal() {
-    if (g_canvas_count == 0) {
-        return;  // No canvases to render
+// Copy the canvas pixels at screen rectangle r (inside the canvas and the screen) opaque
+static void compose_blit_canvas(const canvas_state_t* canvas, const gfx_rect_t* r) {
+    if (canvas->tilemap) {
+        compose_tilemap(canvas, r);
+        return;
     }
+    size_t stride = g_compose_buffer->width();
+    size_t src_stride = canvas->active_width;
+    const uint8_t* src = (const uint8_t*)canvas->render_buffer_mem +
+                         (r->y0 - canvas->push_y) * src_stride + (r->x0 - canvas->push_x);
+    fmrb_blit8_copy((uint8_t*)g_compose_buffer_mem + r->y0 * stride + r->x0, stride,
+                    src, src_stride, r->x1 - r->x0, r->y1 - r->y0);
+}
 
-    // Sort canvases by Z-order (low to high)
-    canvas_sort_by_zorder();
+// Draw the cursor on top of a recomposed area (outside it the cursor is already on screen)
+static void compose_draw_cursor(const gfx_rect_t* area) {
+    gfx_rect_t cursor = rect_make(g_cursor_x, g_cursor_y, CURSOR_SIZE, CURSOR_SIZE);
+    if (!g_cursor_visible || !g_cursor_sprite || !rect_intersect(&cursor, area)) {
+        return;
+    }
+    size_t stride = g_compose_buffer->width();
+    const uint8_t* src = (const uint8_t*)g_cursor_sprite->getBuffer();
+    fmrb_blit8_copy_key((uint8_t*)g_compose_buffer_mem + cursor.y0 * stride + cursor.x0, stride,
+                        src + (cursor.y0 - g_cursor_y) * CURSOR_SIZE + (cursor.x0 - g_cursor_x), CURSOR_SIZE,
+                        cursor.x1 - cursor.x0, cursor.y1 - cursor.y0, CURSOR_TRANSPARENT_COLOR332);
+    GFX_LOG_D("Cursor drawn at (%d, %d)", g_cursor_x, g_cursor_y);
+}
 
-    LGFX_Sprite* screen_buffer = g_canvases[0].render_buffer; //system GUI canvas
+// Rebuild the draw order of the shown sprites (once per frame, after changes)
+static void sprites_sort() {
+    g_sprite_order_dirty = false;
+    g_sprite_order_count = 0;
+    for (size_t i = FMRB_LINK_SPRITE_COUNT; i-- > 0; ) {
+        if (!rect_is_empty(&g_sprites[i].rect)) {
+            g_sprite_order[g_sprite_order_count++] = (uint8_t)i;
+        }
+    }
+    // Ascending priority; the stable sort keeps higher indices below among equals
+    std::stable_sort(g_sprite_order, g_sprite_order + g_sprite_order_count, [](uint8_t a, uint8_t b) {
+        return g_sprites[a].priority < g_sprites[b].priority;
+    });
+}
 
-    // Composite all visible canvases to screen buffer (NOT to g_lgfx directly)
-    for (size_t i = 1; i < g_canvas_count; i++) {
-        canvas_state_t* canvas = &g_canvases[i];
+// Draw screen rectangle r (inside the sprite and the screen) of a sprite
+static void compose_sprite(const gfx_sprite_t* sprite, const image_entry_t* image, const gfx_rect_t* r) {
+    size_t stride = g_compose_buffer->width();
+    uint8_t* dst = (uint8_t*)g_compose_buffer_mem + r->y0 * stride + r->x0;
+    int32_t w = r->x1 - r->x0;
+    int32_t h = r->y1 - r->y0;
+    int32_t sx = r->x0 - sprite->rect.x0;
+    int32_t sy = r->y0 - sprite->rect.y0;
+    bool opaque = sprite->flags & FMRB_LINK_SPRITE_OPAQUE;
+
+    if (!(sprite->flags & (FMRB_LINK_SPRITE_HFLIP | FMRB_LINK_SPRITE_VFLIP))) {
+        const uint8_t* src = image->pixels + sy * image->width + sx;
+        if (opaque) {
+            fmrb_blit8_copy(dst, stride, src, image->width, w, h);
+        } else {
+            fmrb_blit8_copy_key(dst, stride, src, image->width, w, h, g_sprite_key);
+        }
+        return;
+    }
+
+    for (int32_t row = 0; row < h; row++, dst += stride) {
+        int32_t iy = (sprite->flags & FMRB_LINK_SPRITE_VFLIP) ? image->height - 1 - (sy + row) : sy + row;
+        const uint8_t* src = image->pixels + iy * image->width;
+        if (!(sprite->flags & FMRB_LINK_SPRITE_HFLIP)) {
+            if (opaque) {
+                memcpy(dst, src + sx, w);
+            } else {
+                fmrb_blit8_copy_key(dst, stride, src + sx, image->width, w, 1, g_sprite_key);
+            }
+            continue;
+        }
+        src += image->width - 1 - sx;  // Source of dst[0], read backwards
+        for (int32_t i = 0; i < w; i++) {
+            uint8_t c = src[-i];
+            if (opaque || c != g_sprite_key) {
+                dst[i] = c;
+            }
+        }
+    }
+}
+
+// Draw the sprites on top of a recomposed area, bottom to top
+static void compose_draw_sprites(const gfx_rect_t* area) {
+    // Sprites on the rows of the area, with their images (NULL outside the area)
+    uint8_t slots[FMRB_LINK_SPRITE_COUNT];
+    const image_entry_t* images[FMRB_LINK_SPRITE_COUNT];
+    size_t count = 0;
+    for (size_t i = 0; i < g_sprite_order_count; i++) {
+        const gfx_sprite_t* sprite = &g_sprites[g_sprite_order[i]];
+        if (sprite->rect.y1 <= area->y0 || sprite->rect.y0 >= area->y1) {
+            continue;
+        }
+        gfx_rect_t r = sprite->rect;
+        images[count] = rect_intersect(&r, area) ? image_find(sprite->image_id) : nullptr;
+        if (images[count] || g_sprite_line_limit > 0) {
+            slots[count++] = g_sprite_order[i];
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    if (g_sprite_line_limit == 0) {
+        for (size_t i = 0; i < count; i++) {
+            const gfx_sprite_t* sprite = &g_sprites[slots[i]];
+            gfx_rect_t r = sprite->rect;
+            rect_intersect(&r, area);
+            compose_sprite(sprite, images[i], &r);
+        }
+        return;
+    }
+
+    // Scanline limit: each line shows only its topmost g_sprite_line_limit sprites,
+    // counting those outside the area too so that every part of a line agrees
+    for (int32_t y = area->y0; y < area->y1; y++) {
+        size_t shown[FMRB_LINK_SPRITE_COUNT];
+        size_t n = 0;
+        for (size_t i = count; i-- > 0 && n < g_sprite_line_limit; ) {
+            const gfx_sprite_t* sprite = &g_sprites[slots[i]];
+            if (y >= sprite->rect.y0 && y < sprite->rect.y1) {
+                shown[n++] = i;
+            }
+        }
+        while (n-- > 0) {
+            size_t i = shown[n];
+            if (images[i]) {
+                const gfx_sprite_t* sprite = &g_sprites[slots[i]];
+                gfx_rect_t r = { std::max(sprite->rect.x0, area->x0), y, std::min(sprite->rect.x1, area->x1), y + 1 };
+                compose_sprite(sprite, images[i], &r);
+            }
+        }
+    }
+}
+
+// Push a recomposed area to g_lgfx
+static void compose_push(const gfx_rect_t* area) {
+    g_lgfx->setClipRect(area->x0, area->y0, area->x1 - area->x0, area->y1 - area->y0);
+    g_compose_buffer->pushSprite(g_lgfx, 0, 0);
+    g_lgfx->clearClipRect();
+    rect_union(&g_display_dirty, area);
+}
+
+// Recompose the changed screen area (one bounding rectangle) from all visible canvases
+static void compose_area() {
+    if (rect_is_empty(&g_screen_dirty)) {
+        return;  // Nothing to recompose
+    }
+
+    gfx_rect_t area = g_screen_dirty;
+    rect_clear(&g_screen_dirty);
+
+    // Visible canvases in the area, bottom to top. Canvases are blitted opaque,
+    // so nothing below the topmost canvas covering the whole area is painted.
+    canvas_state_t* layers[MAX_CANVAS_COUNT];
+    gfx_rect_t layer_rects[MAX_CANVAS_COUNT];
+    size_t layer_count = 0;
+    bool covered = false;
+    for (size_t i = g_canvas_count; i-- > 0 && !covered; ) {
+        canvas_state_t* canvas = &g_canvases[g_canvas_zorder[i]];
+        gfx_rect_t r = canvas_screen_rect(canvas);
+        if (!canvas->is_visible || !canvas->render_buffer || !rect_intersect(&r, &area)) {
+            continue;
+        }
+        covered = rect_contains(&r, &area);
+        layers[layer_count] = canvas;
+        layer_rects[layer_count] = r;
+        layer_count++;
+    }
+    std::reverse(layers, layers + layer_count);
+    std::reverse(layer_rects, layer_rects + layer_count);
+
+    // Composite into the composition buffer (NOT to g_lgfx directly)
+    gfx_region_t region;
+    if (!covered) {
+        // Background where no canvas is shown
+        region_init(&region, &area);
+        for (size_t i = 0; i < layer_count && region.count > 0; i++) {
+            region_subtract(&region, &layer_rects[i]);
+        }
+        for (int k = 0; k < region.count; k++) {
+            compose_fill(&region.rects[k]);
+        }
+    }
+
+    for (size_t i = 0; i < layer_count; i++) {
+        canvas_state_t* canvas = layers[i];
+
+        // Skip the parts covered by canvases above
+        region_init(&region, &layer_rects[i]);
+        for (size_t j = i + 1; j < layer_count && region.count > 0; j++) {
+            region_subtract(&region, &layer_rects[j]);
+        }
+        GFX_LOG_D("Composite canvas ID=%u at (%d,%d), active_size=%dx%d, z_order=%d, visible_rects=%d",
+                canvas->canvas_id, canvas->push_x, canvas->push_y,
+                canvas->active_width, canvas->active_height, canvas->z_order, region.count);
+
+        // Only uncovered changed pixels are copied
+        for (int k = 0; k < region.count; k++) {
+            compose_blit_canvas(canvas, &region.rects[k]);
+        }
+    }
+
+    compose_draw_sprites(&area);
+    compose_draw_cursor(&area);
+
+    // Push the changed area to g_lgfx (only once per frame)
+    compose_push(&area);
+    GFX_LOG_D("Screen area (%d,%d) %dx%d composed",
+              (int)area.x0, (int)area.y0, (int)(area.x1 - area.x0), (int)(area.y1 - area.y0));
+}
+
+// Screen rectangle of tile (tx, ty), clipped to the screen
+static gfx_rect_t tile_rect(int32_t tx, int32_t ty) {
+    gfx_rect_t r = rect_make(tx * TILE_SIZE, ty * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+    gfx_rect_t screen = { 0, 0, (int32_t)g_compose_buffer->width(), (int32_t)g_compose_buffer->height() };
+    rect_intersect(&r, &screen);
+    return r;
+}
+
+// Rebuild the per-tile canvas lists; tiles whose list changed are marked dirty
+static void tiles_rebin() {
+    g_tiles_rebin = false;
+
+    gfx_rect_t rects[MAX_CANVAS_COUNT];
+    uint8_t slots[MAX_CANVAS_COUNT];
+    size_t count = 0;
+    for (size_t i = 0; i < g_canvas_count; i++) {
+        canvas_state_t* canvas = &g_canvases[g_canvas_zorder[i]];
         if (canvas->is_visible && canvas->render_buffer) {
-            GFX_LOG_D("Composite canvas ID=%u to screen buffer at (%d,%d), active_size=%dx%d, z_order=%d",
-                    canvas->canvas_id, canvas->push_x, canvas->push_y,
-                    canvas->active_width, canvas->active_height, canvas->z_order);
-            canvas->dirty = false;
+            rects[count] = canvas_screen_rect(canvas);
+            slots[count] = g_canvas_zorder[i];
+            count++;
+        }
+    }
+
+    for (int32_t ty = 0; ty < g_tiles_y; ty++) {
+        for (int32_t tx = 0; tx < g_tiles_x; tx++) {
+            gfx_rect_t tr = tile_rect(tx, ty);
+            gfx_tile_t bin;
+            bin.count = 0;
+            for (size_t i = 0; i < count; i++) {
+                gfx_rect_t r = rects[i];
+                if (rect_intersect(&r, &tr)) {
+                    bin.slots[bin.count++] = slots[i];
+                }
+            }
 
-            // Push render_buffer to screen buffer
-            // Since setBuffer configures sprite to active size, pushSprite will only transfer active region
-            canvas->render_buffer->pushSprite(screen_buffer, canvas->push_x, canvas->push_y);
+            size_t index = ty * g_tiles_x + tx;
+            gfx_tile_t* tile = &g_tiles[index];
+            if (tile->count != bin.count || memcmp(tile->slots, bin.slots, bin.count) != 0) {
+                memcpy(tile, &bin, offsetof(gfx_tile_t, slots) + bin.count);
+                g_tile_dirty[index] = 1;
+            }
         }
     }
+}
 
-    // Finally, push the complete screen buffer to g_lgfx (only once per frame)
-    screen_buffer->pushSprite(g_lgfx, 0, 0);
-    GFX_LOG_D("Screen buffer pushed to display");
+// Recompose one tile from its canvas list
+static void compose_tile(const gfx_tile_t* tile, const gfx_rect_t* tr) {
+    // Canvases are blitted opaque: start at the topmost one covering the whole tile
+    size_t first = 0;
+    bool covered = false;
+    for (size_t i = tile->count; i-- > 0; ) {
+        canvas_state_t* canvas = &g_canvases[tile->slots[i]];
+        gfx_rect_t r = canvas_screen_rect(canvas);
+        if (rect_contains(&r, tr)) {
+            first = i;
+            covered = true;
+            break;
+        }
+    }
 
-    // Draw cursor on top of everything (if visible)
-    if (g_cursor_visible && g_cursor_sprite) {
-        g_cursor_sprite->pushSprite(g_lgfx, g_cursor_x, g_cursor_y, CURSOR_TRANSPARENT_COLOR);
-        GFX_LOG_D("Cursor drawn at (%d, %d)", g_cursor_x, g_cursor_y);
+    if (!covered) {
+        compose_fill(tr);
+    }
+    for (size_t i = first; i < tile->count; i++) {
+        canvas_state_t* canvas = &g_canvases[tile->slots[i]];
+        gfx_rect_t r = canvas_screen_rect(canvas);
+        if (rect_intersect(&r, tr)) {
+            compose_blit_canvas(canvas, &r);
+        }
     }
 }
 
-// Get current drawing target (screen or canvas)
-static LovyanGFX* get_current_target() {
-    if (g_current_target == FMRB_CANVAS_SCREEN) {
-        // Draw directly to screen
-        return g_lgfx;
+// Recompose the dirty tiles; each row's runs of dirty tiles are pushed as one rectangle
+static void compose_tiles() {
+    if (g_tiles_rebin) {
+        tiles_rebin();
     }
-    canvas_state_t* canvas = canvas_state_find(g_current_target);
-    if (canvas) {
-        return canvas->draw_buffer;  // Draw to draw_buffer
+
+    int composed = 0;
+    for (int32_t ty = 0; ty < g_tiles_y; ty++) {
+        uint8_t* dirty = &g_tile_dirty[ty * g_tiles_x];
+        for (int32_t tx = 0; tx < g_tiles_x; ) {
+            if (!dirty[tx]) {
+                tx++;
+                continue;
+            }
+            gfx_rect_t span = tile_rect(tx, ty);
+            for (; tx < g_tiles_x && dirty[tx]; tx++) {
+                gfx_rect_t tr = tile_rect(tx, ty);
+                compose_tile(&g_tiles[ty * g_tiles_x + tx], &tr);
+                span.x1 = tr.x1;
+                dirty[tx] = 0;
+                composed++;
+            }
+            compose_draw_sprites(&span);
+            compose_draw_cursor(&span);
+            compose_push(&span);
+        }
+    }
+    if (composed > 0) {
+        GFX_LOG_D("%d tiles composed", composed);
+    }
+}
+
+// Allocate the tile grid for the composition buffer; all tiles start dirty
+static int tiles_init() {
+    g_tiles_x = (g_compose_buffer->width() + TILE_SIZE - 1) / TILE_SIZE;
+    g_tiles_y = (g_compose_buffer->height() + TILE_SIZE - 1) / TILE_SIZE;
+    size_t tile_count = (size_t)g_tiles_x * g_tiles_y;
+    g_tiles = (gfx_tile_t*)calloc(tile_count, sizeof(gfx_tile_t));
+    g_tile_dirty = (uint8_t*)malloc(tile_count);
+    if (!g_tiles || !g_tile_dirty) {
+        GFX_LOG_E("Failed to allocate %dx%d compositor tiles", (int)g_tiles_x, (int)g_tiles_y);
+        free(g_tiles);
+        free(g_tile_dirty);
+        g_tiles = nullptr;
+        g_tile_dirty = nullptr;
+        return -1;
+    }
+    memset(g_tile_dirty, 1, tile_count);
+    g_tiles_rebin = true;
+    return 0;
+}
+
+static void tiles_free() {
+    free(g_tiles);
+    free(g_tile_dirty);
+    g_tiles = nullptr;
+    g_tile_dirty = nullptr;
+    g_tiles_x = 0;
+    g_tiles_y = 0;
+}
+
+// Recompose the changed screen area from all visible canvases in Z-order
+static void graphics_handler_compose() {
+    canvas_sort_by_zorder();
+    if (g_sprite_order_dirty) {
+        sprites_sort();
+    }
+
+    if (!g_compose_buffer) {
+        return;
+    }
+    if (g_compositor == GFX_COMPOSITOR_TILES) {
+        compose_tiles();
+    } else {
+        compose_area();
+    }
+}
+
+// Compose and update the display; idle frames do neither
+static int graphics_handler_render_frame_internal() {
+    graphics_handler_compose();
+
+    if (rect_is_empty(&g_display_dirty)) {
+        return 0;
+    }
+
+    gfx_rect_t area = g_display_dirty;
+    rect_clear(&g_display_dirty);
+    g_lgfx->display(area.x0, area.y0, area.x1 - area.x0, area.y1 - area.y0);
+    GFX_LOG_D("Display updated: (%d,%d)-(%d,%d)", (int)area.x0, (int)area.y0, (int)area.x1, (int)area.y1);
+    return 1;
+}
+
+static void cursor_mark_dirty() {
+    if (g_cursor_visible) {
+        screen_mark_dirty(rect_make(g_cursor_x, g_cursor_y, CURSOR_SIZE, CURSOR_SIZE));
+    }
+}
+
+// Present a canvas: copy draw_buffer to its own render_buffer at (0,0) and
+// save the position for screen composition. Only the area drawn since the
+// last present is copied and recomposed, unless the transparency setting
+// changed or the canvas was resized.
+static int canvas_present(canvas_state_t* canvas, const fmrb_link_graphics_push_canvas_t* cmd) {
+    int16_t key = cmd->use_transparency ? cmd->transparent_color : CANVAS_PRESENT_OPAQUE;
+    gfx_rect_t changed = canvas->dirty;
+    if (canvas->present_key != key) {
+        changed = rect_make(0, 0, canvas->active_width, canvas->active_height);
+    }
+
+    bool moved = !canvas->is_visible || canvas->push_x != cmd->x || canvas->push_y != cmd->y;
+    if (moved) {
+        canvas_mark_exposed(canvas);
+        canvas->push_x = cmd->x;
+        canvas->push_y = cmd->y;
+        canvas->is_visible = true;  // Make visible on first present()
+    }
+
+    if (!rect_is_empty(&changed)) {
+        canvas_copy_rect(canvas, canvas->render_buffer_mem, canvas->draw_buffer_mem, &changed, key);
+    }
+    GFX_LOG_D("PRESENT: canvas %u at (%d,%d), changed=(%d,%d)-(%d,%d)%s",
+              canvas->canvas_id, canvas->push_x, canvas->push_y,
+              (int)changed.x0, (int)changed.y0, (int)changed.x1, (int)changed.y1,
+              moved ? ", moved" : "");
+
+    if (moved) {
+        canvas_mark_exposed(canvas);
+    } else if (!rect_is_empty(&changed)) {
+        screen_mark_dirty(rect_make(canvas->push_x + changed.x0, canvas->push_y + changed.y0,
+                                    changed.x1 - changed.x0, changed.y1 - changed.y0));
+    }
+
+    canvas->present_key = key;
+    rect_clear(&canvas->dirty);
+    return 0;
+}
+
+// Present a canvas by swapping its draw and render buffers. Commands are
+// applied by the graphics task between frames, so the compositor never sees a
+// half-swapped canvas. With preserve, the area drawn since the last present is
+// copied back so draw_buffer again equals what is shown.
+static int canvas_swap_present(canvas_state_t* canvas, bool preserve) {
+    // Only the drawn area differs from the shown frame while both buffers were in sync
+    gfx_rect_t changed = canvas->dirty;
+    if (canvas->present_key != CANVAS_PRESENT_OPAQUE) {
+        changed = rect_make(0, 0, canvas->active_width, canvas->active_height);
+    }
+
+    std::swap(canvas->draw_buffer_mem, canvas->render_buffer_mem);
+    canvas->draw_buffer->setBuffer(canvas->draw_buffer_mem, canvas->active_width, canvas->active_height, 8);
+    canvas->render_buffer->setBuffer(canvas->render_buffer_mem, canvas->active_width, canvas->active_height, 8);
+
+    if (preserve && canvas->present_key == CANVAS_PRESENT_OPAQUE) {
+        // draw_buffer holds the previous frame: only the drawn area is out of date
+        if (!rect_is_empty(&canvas->dirty)) {
+            canvas_copy_rect(canvas, canvas->draw_buffer_mem, canvas->render_buffer_mem,
+                             &canvas->dirty, CANVAS_PRESENT_OPAQUE);
+        }
+        canvas->present_key = CANVAS_PRESENT_OPAQUE;
+    } else if (preserve) {
+        canvas_copy_rect(canvas, canvas->draw_buffer_mem, canvas->render_buffer_mem,
+                         &changed, CANVAS_PRESENT_OPAQUE);
+        canvas->present_key = CANVAS_PRESENT_OPAQUE;
+    } else {
+        canvas->present_key = CANVAS_PRESENT_STALE;  // draw_buffer holds an older frame
+    }
+    GFX_LOG_D("PRESENT: canvas %u swapped, changed=(%d,%d)-(%d,%d)%s",
+              canvas->canvas_id, (int)changed.x0, (int)changed.y0, (int)changed.x1, (int)changed.y1,
+              preserve ? ", preserved" : "");
+
+    if (!canvas->is_visible) {
+        canvas->is_visible = true;  // Make visible on first present()
+        canvas_mark_exposed(canvas);
+    } else if (!rect_is_empty(&changed)) {
+        screen_mark_dirty(rect_make(canvas->push_x + changed.x0, canvas->push_y + changed.y0,
+                                    changed.x1 - changed.x0, changed.y1 - changed.y0));
+    }
+    rect_clear(&canvas->dirty);
+    return 0;
+}
+
+// Get current drawing target (screen or canvas)
+static LovyanGFX* get_current_target() {
+    if (g_current_target == FMRB_CANVAS_SCREEN) {
+        // Draw directly to screen
+        return g_lgfx;
+    }
+    canvas_state_t* canvas = canvas_state_find(g_current_target);
+    if (canvas) {
+        return canvas->draw_buffer;  // Draw to draw_buffer
+    }
+    GFX_LOG_E("Canvas %u not found, using screen", g_current_target);
+    return g_lgfx;  // Fallback to screen
+}
+
+// Screen part of target_draw_pixels8. The screen has no direct memory access, so
+// rows are pushed through LovyanGFX; keyed rows are read back first and blended
+// with the same kernel as the compositor.
+static void target_draw_screen8(const gfx_rect_t* r, const uint8_t* src, size_t src_stride, int16_t key) {
+    gfx_rect_t screen = { 0, 0, g_lgfx->width(), g_lgfx->height() };
+    gfx_rect_t clipped = *r;
+    if (!rect_intersect(&clipped, &screen)) {
+        return;
+    }
+    src += (clipped.y0 - r->y0) * src_stride + (clipped.x0 - r->x0);
+    int32_t w = clipped.x1 - clipped.x0;
+
+    uint8_t* line = nullptr;
+    if (key >= 0) {
+        line = (uint8_t*)fmrb_buf_pool_alloc(w, nullptr);
+        if (!line) {
+            GFX_LOG_E("Failed to allocate a %d-pixel line for a keyed screen draw", (int)w);
+            return;
+        }
+    }
+    for (int32_t y = clipped.y0; y < clipped.y1; y++, src += src_stride) {
+        if (line) {
+            g_lgfx->readRect(clipped.x0, y, w, 1, (lgfx::rgb332_t*)line);
+            fmrb_blit8_copy_key(line, w, src, src_stride, w, 1, (uint8_t)key);
+            g_lgfx->pushImage(clipped.x0, y, w, 1, (const lgfx::rgb332_t*)line);
+        } else {
+            g_lgfx->pushImage(clipped.x0, y, w, 1, (const lgfx::rgb332_t*)src);
+        }
+    }
+    fmrb_buf_pool_free(line);
+    display_mark_dirty(clipped);
+}
+
+// Draw w x h RGB332 pixels (row stride src_stride) at (x, y) on a canvas draw buffer or
+// the screen, skipping pixels equal to key unless key is CANVAS_PRESENT_OPAQUE
+static void target_draw_pixels8(canvas_state_t* canvas, int32_t x, int32_t y, const uint8_t* src,
+                                size_t src_stride, int32_t w, int32_t h, int16_t key) {
+    gfx_rect_t r = rect_make(x, y, w, h);
+    if (!canvas) {
+        target_draw_screen8(&r, src, src_stride, key);
+        return;
+    }
+
+    gfx_rect_t active = { 0, 0, canvas->active_width, canvas->active_height };
+    if (!rect_intersect(&r, &active)) {
+        return;
+    }
+    size_t stride = canvas->active_width;
+    uint8_t* dst = (uint8_t*)canvas->draw_buffer_mem + r.y0 * stride + r.x0;
+    src += (r.y0 - y) * src_stride + (r.x0 - x);
+    if (key >= 0) {
+        fmrb_blit8_copy_key(dst, stride, src, src_stride, r.x1 - r.x0, r.y1 - r.y0, (uint8_t)key);
+    } else {
+        fmrb_blit8_copy(dst, stride, src, src_stride, r.x1 - r.x0, r.y1 - r.y0);
+    }
+    canvas_mark_dirty(canvas, r);
+}
+
+// Resolve a drawing target once: the screen (canvas = NULL) or a canvas draw buffer
+static LovyanGFX* target_resolve(uint16_t canvas_id, canvas_state_t** canvas) {
+    *canvas = nullptr;
+    if (canvas_id == FMRB_CANVAS_SCREEN) {
+        return g_lgfx;
+    }
+    *canvas = canvas_state_find(canvas_id);
+    if (!*canvas) {
+        GFX_LOG_E("Canvas %u not found", canvas_id);
+        return nullptr;
+    }
+    return (*canvas)->draw_buffer;
+}
+
+// Items of a bulk command, or NULL if the payload is shorter than count items
+static const uint8_t* bulk_items(const uint8_t* data, size_t size, size_t hdr_size,
+                                 uint16_t count, size_t item_size) {
+    if ((size - hdr_size) / item_size < count) {
+        GFX_LOG_E("Bulk command truncated (%u items of %zu bytes, %zu bytes received)",
+                  count, item_size, size - hdr_size);
+        return nullptr;
+    }
+    return data + hdr_size;
+}
+
+static image_entry_t* image_find(uint16_t image_id) {
+    if (image_id == 0) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < IMAGE_TABLE_SIZE; i++) {
+        image_entry_t* e = &g_images[(image_id + i) & (IMAGE_TABLE_SIZE - 1)];
+        if (e->image_id == image_id) {
+            return e;
+        }
+        if (e->image_id == 0) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+static void image_delete(image_entry_t* e) {
+    fmrb_buf_pool_free(e->pixels);
+    g_image_count--;
+
+    // Backward-shift deletion: move later entries of the probe chain into the gap
+    size_t hole = e - g_images;
+    size_t i = hole;
+    for (;;) {
+        i = (i + 1) & (IMAGE_TABLE_SIZE - 1);
+        image_entry_t* next = &g_images[i];
+        if (next->image_id == 0) {
+            break;
+        }
+        size_t home = next->image_id & (IMAGE_TABLE_SIZE - 1);
+        // Move it unless its home lies cyclically in (hole, i]
+        if (((i - home) & (IMAGE_TABLE_SIZE - 1)) >= ((i - hole) & (IMAGE_TABLE_SIZE - 1))) {
+            g_images[hole] = *next;
+            hole = i;
+        }
+    }
+    g_images[hole].image_id = 0;
+    g_images[hole].pixels = nullptr;
+}
+
+// Decode BMP/PNG/JPEG data (format detected from the header) or copy raw RGB332
+// pixels into a new pixel buffer. Returns nullptr on failure.
+static uint8_t* image_decode(uint16_t image_id, uint16_t width, uint16_t height,
+                             const uint8_t* data, size_t len, bool encoded) {
+    if (image_id == 0 || width == 0 || height == 0) {
+        GFX_LOG_E("Invalid image %u (%dx%d)", image_id, width, height);
+        return nullptr;
+    }
+    size_t size = (size_t)width * height;
+    if (!encoded && len < size) {
+        GFX_LOG_E("Image %u: %zu bytes of pixels, %zu expected", image_id, len, size);
+        return nullptr;
+    }
+
+    uint8_t* pixels = (uint8_t*)fmrb_buf_pool_alloc(size, nullptr);
+    if (!pixels) {
+        GFX_LOG_E("Failed to allocate image %u (%dx%d)", image_id, width, height);
+        return nullptr;
+    }
+    if (!encoded) {
+        memcpy(pixels, data, size);
+        return pixels;
+    }
+
+    // Decode through LovyanGFX into a sprite wrapping the new pixels
+    LGFX_Sprite sprite(g_lgfx);
+    sprite.setColorDepth(8);
+    sprite.setBuffer(pixels, width, height, 8);
+    sprite.fillScreen(FMRB_COLOR_BLACK);
+    bool ok;
+    if (len >= 2 && data[0] == 'B' && data[1] == 'M') {
+        ok = sprite.drawBmp(data, (uint32_t)len);
+    } else if (len >= 8 && memcmp(data, "\x89PNG", 4) == 0) {
+        ok = sprite.drawPng(data, (uint32_t)len);
+    } else if (len >= 2 && data[0] == 0xFF && data[1] == 0xD8) {
+        ok = sprite.drawJpg(data, (uint32_t)len);
+    } else {
+        GFX_LOG_E("Image %u: unknown encoded format", image_id);
+        ok = false;
+    }
+    if (!ok) {
+        GFX_LOG_E("Image %u: failed to decode %zu bytes", image_id, len);
+        fmrb_buf_pool_free(pixels);
+        return nullptr;
+    }
+    return pixels;
+}
+
+// Store decoded pixels under image_id, replacing the pixels of an existing image
+// only now that the new ones are complete. Takes ownership of pixels.
+static int image_install(uint16_t image_id, uint16_t width, uint16_t height, uint8_t* pixels) {
+    image_entry_t* e = image_find(image_id);
+    if (e) {
+        fmrb_buf_pool_free(e->pixels);
+    } else {
+        if (g_image_count >= MAX_IMAGE_COUNT) {
+            GFX_LOG_E("Maximum image count reached (%d)", MAX_IMAGE_COUNT);
+            fmrb_buf_pool_free(pixels);
+            return -1;
+        }
+        e = &g_images[image_id & (IMAGE_TABLE_SIZE - 1)];
+        while (e->image_id != 0) {
+            e = &g_images[(e - g_images + 1) & (IMAGE_TABLE_SIZE - 1)];
+        }
+        e->image_id = image_id;
+        g_image_count++;
+    }
+    e->width = width;
+    e->height = height;
+    e->pixels = pixels;
+    return 0;
+}
+
+// Screen rows a sprite area affects: with a scanline limit, the sprites shown
+// on a line depend on every sprite crossing it
+static void sprite_mark_dirty(const gfx_rect_t* r) {
+    if (rect_is_empty(r)) {
+        return;
+    }
+    if (g_sprite_line_limit > 0) {
+        screen_mark_dirty(rect_bounds(0, r->y0, g_lgfx->width() - 1, r->y1 - 1));
+    } else {
+        screen_mark_dirty(*r);
+    }
+}
+
+// Recompute the screen area of a sprite after it or its image changed
+static void sprite_refresh(gfx_sprite_t* sprite) {
+    sprite_mark_dirty(&sprite->rect);
+    rect_clear(&sprite->rect);
+    if (sprite->flags & FMRB_LINK_SPRITE_VISIBLE) {
+        const image_entry_t* image = image_find(sprite->image_id);
+        if (image) {
+            sprite->rect = rect_make(sprite->x, sprite->y, image->width, image->height);
+        }
+    }
+    sprite_mark_dirty(&sprite->rect);
+    g_sprite_order_dirty = true;
+}
+
+static void sprites_mark_all_dirty() {
+    for (size_t i = 0; i < FMRB_LINK_SPRITE_COUNT; i++) {
+        sprite_mark_dirty(&g_sprites[i].rect);
+    }
+}
+
+// An image was created, replaced or deleted: recompose the tilemaps and sprites using it
+static void image_changed(uint16_t image_id) {
+    for (size_t i = 0; i < g_canvas_count; i++) {
+        canvas_state_t* canvas = &g_canvases[g_canvas_zorder[i]];
+        if (canvas->tilemap && canvas->tilemap->image_id == image_id) {
+            canvas_mark_exposed(canvas);
+        }
+    }
+    for (size_t i = 0; i < FMRB_LINK_SPRITE_COUNT; i++) {
+        if (g_sprites[i].image_id == image_id) {
+            sprite_refresh(&g_sprites[i]);
+        }
+    }
+}
+
+// Attach a tilemap to a canvas (replacing any previous one); all cells start as tile 0
+static int tilemap_set(canvas_state_t* canvas, const fmrb_link_graphics_set_tilemap_t* cmd) {
+    canvas_mark_exposed(canvas);
+    free(canvas->tilemap);
+    canvas->tilemap = nullptr;
+    if (cmd->image_id == 0) {
+        return 0;  // Removed: the canvas shows its own pixels again
+    }
+
+    size_t cells = (size_t)cmd->map_w * cmd->map_h;
+    if (cmd->tile_w == 0 || cmd->tile_h == 0 || cells == 0 || cells > TILEMAP_MAX_CELLS ||
+        (int64_t)cmd->map_w * cmd->tile_w > TILEMAP_MAX_PIXELS ||
+        (int64_t)cmd->map_h * cmd->tile_h > TILEMAP_MAX_PIXELS) {
+        GFX_LOG_E("Invalid tilemap for canvas %u (tile %dx%d, map %dx%d)",
+                  canvas->canvas_id, cmd->tile_w, cmd->tile_h, cmd->map_w, cmd->map_h);
+        return -1;
+    }
+
+    // Header and cells in one allocation
+    tilemap_t* tm = (tilemap_t*)calloc(1, sizeof(tilemap_t) + cells * sizeof(uint16_t));
+    if (!tm) {
+        GFX_LOG_E("Failed to allocate %dx%d tilemap for canvas %u", cmd->map_w, cmd->map_h, canvas->canvas_id);
+        return -1;
+    }
+    tm->image_id = cmd->image_id;
+    tm->tile_w = cmd->tile_w;
+    tm->tile_h = cmd->tile_h;
+    tm->map_w = cmd->map_w;
+    tm->map_h = cmd->map_h;
+    tm->tiles = (uint16_t*)(tm + 1);
+    canvas->tilemap = tm;
+
+    // Shown in place of the canvas pixels; visibility is still up to the client
+    canvas_mark_exposed(canvas);
+    return 0;
+}
+
+static void image_delete_all() {
+    for (size_t i = 0; i < IMAGE_TABLE_SIZE; i++) {
+        if (g_images[i].image_id != 0) {
+            fmrb_buf_pool_free(g_images[i].pixels);
+            g_images[i].image_id = 0;
+            g_images[i].pixels = nullptr;
+        }
+    }
+    g_image_count = 0;
+}
+
+static display_list_t* list_find(uint16_t list_id) {
+    for (size_t i = 0; i < MAX_DISPLAY_LISTS; i++) {
+        if (g_lists[i].list_id == list_id) {
+            return &g_lists[i];
+        }
+    }
+    return nullptr;
+}
+
+static void list_discard_recording() {
+    free(g_list_rec.data);
+    g_list_rec = {};
+    g_list_rec_capacity = 0;
+    g_list_rec_failed = false;
+}
+
+static void list_delete_all() {
+    for (size_t i = 0; i < MAX_DISPLAY_LISTS; i++) {
+        free(g_lists[i].data);
+        g_lists[i] = {};
+    }
+    list_discard_recording();
+    free(g_list_scratch);
+    g_list_scratch = nullptr;
+    g_list_scratch_size = 0;
+}
+
+extern "C" int graphics_handler_init(void) {
+    // Prevent multiple initializations
+    if (g_graphics_initialized) {
+        GFX_LOG_E("Graphics handler already initialized, ignoring request");
+        return 0;  // Return success to avoid breaking caller
+    }
+
+    if (!g_lgfx) {
+        GFX_LOG_E("LGFX instance not created");
+        return -1;
+    }
+
+    g_lgfx->setAutoDisplay(false);
+
+    if (fmrb_spsc_ring_init(&g_cmd_ring, GFX_CMD_QUEUE_SIZE) != 0) {
+        GFX_LOG_E("Failed to allocate command queue");
+        return -1;
+    }
+
+    // Composition buffer at display size (RGB332 = 1 byte per pixel)
+    int32_t screen_w = g_lgfx->width();
+    int32_t screen_h = g_lgfx->height();
+    g_compose_buffer_mem = malloc((size_t)screen_w * screen_h);
+    if (!g_compose_buffer_mem) {
+        GFX_LOG_E("Failed to allocate composition buffer (%dx%d)", (int)screen_w, (int)screen_h);
+        fmrb_spsc_ring_free(&g_cmd_ring);
+        return -1;
+    }
+    g_compose_buffer = new LGFX_Sprite(g_lgfx);
+    g_compose_buffer->setColorDepth(8);  // RGB332
+    g_compose_buffer->setBuffer(g_compose_buffer_mem, screen_w, screen_h, 8);
+    g_screen_dirty = rect_make(0, 0, screen_w, screen_h);
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+    // FMRB_COMPOSITOR=tiles selects the tile-binned compositor
+    const char* compositor = getenv("FMRB_COMPOSITOR");
+    if (compositor && strcmp(compositor, "tiles") == 0) {
+        g_compositor = GFX_COMPOSITOR_TILES;
+    }
+#endif
+    if (g_compositor == GFX_COMPOSITOR_TILES && tiles_init() < 0) {
+        g_compositor = GFX_COMPOSITOR_AREA;
+    }
+
+    // Pre-rasterised glyphs for DRAW_STRING (print() is used without them)
+    if (glyph_atlas_init() < 0) {
+        GFX_LOG_E("Glyph atlas unavailable, text is drawn with print()");
+    }
+
+    // Initialize cursor sprite (8x8 arrow)
+    g_cursor_sprite = new LGFX_Sprite(g_lgfx);
+    g_cursor_sprite->setColorDepth(8);  // 8-bit color
+    g_cursor_sprite->createSprite(8, 8);
+    g_cursor_sprite->clear(CURSOR_TRANSPARENT_COLOR);
+
+    // Draw cursor pattern
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            uint32_t color;
+            switch (cursor_pattern[y][x]) {
+                case 1: color = 0xFFFFFF; break;  // White outline
+                case 2: color = 0x000000; break;  // Black body
+                default: color = CURSOR_TRANSPARENT_COLOR; break;  // Transparent
+            }
+            g_cursor_sprite->drawPixel(x, y, color);
+        }
+    }
+
+    g_graphics_initialized = true;  // Mark as initialized
+    GFX_LOG_I("Graphics handler initialized with screen buffer (%dx%d)",
+              (int)g_lgfx->width(), (int)g_lgfx->height());
+    GFX_LOG_I("Cursor sprite initialized (8x8) at position (%d, %d)", g_cursor_x, g_cursor_y);
+    return 0;
+}
+
+extern "C" void graphics_handler_cleanup(void) {
+    // Drop commands that were never applied
+    uint32_t limit = fmrb_spsc_ring_snapshot(&g_cmd_ring);
+    uint32_t len;
+    const void *rec;
+    while (g_cmd_ring.buf && (rec = fmrb_spsc_ring_peek(&g_cmd_ring, limit, &len)) != nullptr) {
+        gfx_cmd_record_t hdr;
+        memcpy(&hdr, rec, sizeof(hdr));
+        free(hdr.ext_data);
+        fmrb_spsc_ring_release(&g_cmd_ring);
+    }
+    fmrb_spsc_ring_free(&g_cmd_ring);
+
+    // Delete all canvases
+    while (g_canvas_count > 0) {
+        canvas_state_free(&g_canvases[g_canvas_zorder[0]]);
+    }
+    g_canvas_zorder_dirty = false;
+    image_delete_all();
+    list_delete_all();
+    fmrb_buf_pool_trim();  // Release the cached canvas and image buffers
+    memset(g_sprites, 0, sizeof(g_sprites));
+    g_sprite_order_count = 0;
+    g_sprite_order_dirty = false;
+
+    // Delete composition buffer
+    if (g_compose_buffer) {
+        delete g_compose_buffer;
+        g_compose_buffer = nullptr;
+    }
+    free(g_compose_buffer_mem);
+    g_compose_buffer_mem = nullptr;
+    tiles_free();
+    rect_clear(&g_screen_dirty);
+    rect_clear(&g_display_dirty);
+
+    glyph_atlas_cleanup();
+
+    // Delete cursor sprite
+    if (g_cursor_sprite) {
+        delete g_cursor_sprite;
+        g_cursor_sprite = nullptr;
+        GFX_LOG_I("Cursor sprite deleted");
+    }
+
+    // All canvases are gone; keep generations so old IDs stay invalid
+    g_canvas_id_used = 0;
+
+    g_current_target = FMRB_CANVAS_SCREEN;
+    g_graphics_initialized = false;  // Reset initialization flag
+
+    // Note: g_lgfx is managed by main.cpp, don't delete here
+    GFX_LOG_I("Graphics handler cleaned up");
+}
+
+// SDL_Renderer function removed - not needed in abstracted interface
+
+extern "C" int graphics_handler_set_compositor(gfx_compositor_t mode) {
+    if (mode == g_compositor) {
+        return 0;
+    }
+    if (!g_compose_buffer) {
+        g_compositor = mode;  // Applied by graphics_handler_init()
+        return 0;
+    }
+
+    if (mode == GFX_COMPOSITOR_TILES) {
+        if (tiles_init() < 0) {
+            return -1;
+        }
+    } else {
+        tiles_free();
+    }
+    g_compositor = mode;
+    screen_mark_dirty(rect_make(0, 0, g_compose_buffer->width(), g_compose_buffer->height()));
+    GFX_LOG_I("Compositor mode set to %s", mode == GFX_COMPOSITOR_TILES ? "tiles" : "area");
+    return 0;
+}
+
+extern "C" int graphics_handler_render_frame(void) {
+    if (!g_lgfx) {
+        return 0;
+    }
+    return graphics_handler_render_frame_internal();
+}
+
+// Use comm_interface send_ack function
+// (No forward declaration needed - using COMM_INTERFACE macro)
+
+// Canvas ID allocation (comm task only), see g_canvas_id_used
+static uint16_t canvas_id_alloc(void) {
+    uint64_t free_slots = ~g_canvas_id_used & ((1ull << MAX_CANVAS_COUNT) - 1);
+    if (free_slots == 0) {
+        return FMRB_CANVAS_INVALID;
+    }
+    uint32_t slot = (uint32_t)__builtin_ctzll(free_slots);
+    g_canvas_id_used |= 1ull << slot;
+    return (uint16_t)((g_canvas_id_gen[slot] << CANVAS_SLOT_BITS) | (slot + 1));
+}
+
+static void canvas_id_release(uint16_t canvas_id) {
+    uint32_t slot = (uint32_t)(canvas_id & CANVAS_SLOT_MASK) - 1;
+    if (slot >= MAX_CANVAS_COUNT || !(g_canvas_id_used & (1ull << slot)) ||
+        (canvas_id >> CANVAS_SLOT_BITS) != g_canvas_id_gen[slot]) {
+        return;  // Not a live canvas; the DELETE_CANVAS fails when applied
+    }
+    g_canvas_id_used &= ~(1ull << slot);
+    g_canvas_id_gen[slot] = (uint16_t)((g_canvas_id_gen[slot] + 1) % CANVAS_GEN_COUNT);
+}
+
+// Assign the ID of a CREATE_CANVAS command and acknowledge it with the ID.
+// Runs on the comm task at enqueue time, after cmd_canvas_ids_available() has
+// checked that enough IDs are free; the canvas itself is created when the
+// command is applied (see the queueing contract in fmrb_link_protocol.h).
+static void cmd_assign_canvas_id(uint8_t msg_type, uint8_t seq, uint8_t *data) {
+    // Allocate new canvas ID (ignore cmd->canvas_id from client)
+    uint16_t canvas_id = canvas_id_alloc();
+    memcpy(data + offsetof(fmrb_link_graphics_create_canvas_t, canvas_id), &canvas_id, sizeof(canvas_id));
+
+    // Send ACK with canvas_id (socket, simulated SPI or SPI slave transport)
+    COMM_INTERFACE->send_ack(msg_type, seq, (const uint8_t*)&canvas_id, sizeof(canvas_id));
+}
+
+static void cmd_track_canvas_id(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, uint8_t *data, size_t size) {
+    if (cmd_type == FMRB_LINK_GFX_CREATE_CANVAS && size >= sizeof(fmrb_link_graphics_create_canvas_t)) {
+        cmd_assign_canvas_id(msg_type, seq, data);
+    } else if (cmd_type == FMRB_LINK_GFX_DELETE_CANVAS && size >= sizeof(fmrb_link_graphics_delete_canvas_t)) {
+        uint16_t canvas_id;
+        memcpy(&canvas_id, data + offsetof(fmrb_link_graphics_delete_canvas_t, canvas_id), sizeof(canvas_id));
+        canvas_id_release(canvas_id);
+    }
+}
+
+static int graphics_execute_command(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, const uint8_t *data, size_t size);
+
+// Check the framing of every BATCH record: header, length within the payload, no nested BATCH
+static int batch_validate(const uint8_t *data, size_t size) {
+    if (size < sizeof(fmrb_link_graphics_batch_t)) {
+        GFX_LOG_E("BATCH: header truncated (size=%zu)", size);
+        return -1;
+    }
+    fmrb_link_graphics_batch_t batch;
+    memcpy(&batch, data, sizeof(batch));
+    const uint8_t *p = data + sizeof(batch);
+    const uint8_t *end = data + size;
+    for (uint16_t i = 0; i < batch.count; i++) {
+        if ((size_t)(end - p) < sizeof(fmrb_link_graphics_batch_item_t)) {
+            GFX_LOG_E("BATCH: truncated at record %u/%u", i, batch.count);
+            return -1;
+        }
+        fmrb_link_graphics_batch_item_t item;
+        memcpy(&item, p, sizeof(item));
+        p += sizeof(item);
+        if ((size_t)(end - p) < item.len || item.cmd_type == FMRB_LINK_GFX_BATCH) {
+            GFX_LOG_E("BATCH: invalid record %u/%u (cmd=0x%02x, len=%u)",
+                      i, batch.count, item.cmd_type, item.len);
+            return -1;
+        }
+        p += item.len;
+    }
+    return 0;
+}
+
+// Number of CREATE_CANVAS commands in a (validated) command or batch
+static int cmd_count_creates(uint8_t cmd_type, const uint8_t *data, size_t size) {
+    if (cmd_type != FMRB_LINK_GFX_BATCH) {
+        return (cmd_type == FMRB_LINK_GFX_CREATE_CANVAS && size >= sizeof(fmrb_link_graphics_create_canvas_t)) ? 1 : 0;
+    }
+    fmrb_link_graphics_batch_t batch;
+    memcpy(&batch, data, sizeof(batch));
+    const uint8_t *p = data + sizeof(batch);
+    int creates = 0;
+    for (uint16_t i = 0; i < batch.count; i++) {
+        fmrb_link_graphics_batch_item_t item;
+        memcpy(&item, p, sizeof(item));
+        p += sizeof(item);
+        if (item.cmd_type == FMRB_LINK_GFX_CREATE_CANVAS && item.len >= sizeof(fmrb_link_graphics_create_canvas_t)) {
+            creates++;
+        }
+        p += item.len;
+    }
+    return creates;
+}
+
+// Refuse the whole command when its CREATE_CANVAS records cannot all get an ID,
+// so no ID is ever acknowledged that the client cannot use
+static bool cmd_canvas_ids_available(uint8_t cmd_type, const uint8_t *data, size_t size) {
+    int creates = cmd_count_creates(cmd_type, data, size);
+    if (creates == 0) {
+        return true;
+    }
+    uint64_t free_slots = ~g_canvas_id_used & ((1ull << MAX_CANVAS_COUNT) - 1);
+    if (__builtin_popcountll(free_slots) < creates) {
+        GFX_LOG_E("Maximum canvas count reached (%d)", MAX_CANVAS_COUNT);
+        return false;
+    }
+    return true;
+}
+
+static void cmd_assign_canvas_ids(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, uint8_t *data, size_t size) {
+    if (cmd_type != FMRB_LINK_GFX_BATCH) {
+        cmd_track_canvas_id(msg_type, cmd_type, seq, data, size);
+        return;
+    }
+
+    // CREATE_CANVAS/DELETE_CANVAS inside a batch (framing checked by batch_validate)
+    fmrb_link_graphics_batch_t batch;
+    memcpy(&batch, data, sizeof(batch));
+    uint8_t *p = data + sizeof(batch);
+    uint8_t *end = data + size;
+    for (uint16_t i = 0; i < batch.count && (size_t)(end - p) >= sizeof(fmrb_link_graphics_batch_item_t); i++) {
+        fmrb_link_graphics_batch_item_t item;
+        memcpy(&item, p, sizeof(item));
+        p += sizeof(item);
+        cmd_track_canvas_id(msg_type, item.cmd_type, seq, p, item.len);
+        p += item.len;
+    }
+}
+
+// Queue a decoded command for the graphics task (comm task side).
+// Everything that can be checked without touching canvas state is checked here,
+// because the ACK goes out as soon as this returns 0.
+extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, const uint8_t *data, size_t size) {
+    if (!g_lgfx || !g_graphics_initialized) {
+        return -1;
+    }
+    if (cmd_type == FMRB_LINK_GFX_BATCH && batch_validate(data, size) != 0) {
+        return -1;
+    }
+    if (!cmd_canvas_ids_available(cmd_type, data, size)) {
+        return -1;
+    }
+
+    bool inline_data = size <= GFX_CMD_INLINE_MAX;
+    uint32_t rec_len = sizeof(gfx_cmd_record_t) + (inline_data ? size : 0);
+
+    // Ring full: do not wait here, that would stall the link for every transport.
+    // The command stays unacknowledged and the client retransmits it once the
+    // graphics task has drained the queue at the next frame boundary.
+    uint8_t *rec = (uint8_t*)fmrb_spsc_ring_reserve(&g_cmd_ring, rec_len);
+    if (!rec) {
+        GFX_LOG_D("Command queue full, cmd=0x%02x (size=%zu) left for retransmission", cmd_type, size);
+        return -1;
+    }
+
+    gfx_cmd_record_t hdr = { msg_type, cmd_type, seq, 0, (uint32_t)size, nullptr };
+    uint8_t *payload = rec + sizeof(hdr);
+    if (!inline_data) {
+        hdr.ext_data = (uint8_t*)malloc(size);
+        if (!hdr.ext_data) {
+            GFX_LOG_E("Failed to allocate %zu bytes for cmd=0x%02x", size, cmd_type);
+            return -1;  // Reservation is simply not committed
+        }
+        payload = hdr.ext_data;
+    }
+    if (size > 0) {
+        memcpy(payload, data, size);
+    }
+    cmd_assign_canvas_ids(msg_type, cmd_type, seq, payload, size);
+
+    memcpy(rec, &hdr, sizeof(hdr));
+    fmrb_spsc_ring_commit(&g_cmd_ring);
+    return 0;
+}
+
+// Apply queued commands (graphics task side). Only commands queued before the
+// call are applied, so a busy producer cannot hold back the frame.
+extern "C" int graphics_handler_drain_commands(void) {
+    if (!g_cmd_ring.buf) {
+        return 0;
+    }
+
+    uint32_t limit = fmrb_spsc_ring_snapshot(&g_cmd_ring);
+    uint32_t len;
+    const void *rec;
+    int applied = 0;
+
+    while ((rec = fmrb_spsc_ring_peek(&g_cmd_ring, limit, &len)) != nullptr) {
+        gfx_cmd_record_t hdr;
+        memcpy(&hdr, rec, sizeof(hdr));
+        const uint8_t *payload = hdr.ext_data ? hdr.ext_data : (const uint8_t*)rec + sizeof(hdr);
+
+        if (graphics_execute_command(hdr.msg_type, hdr.cmd_type, hdr.seq, payload, hdr.size) != 0) {
+            GFX_LOG_E("Queued command 0x%02x (seq=%u) failed", hdr.cmd_type, hdr.seq);
+        }
+
+        free(hdr.ext_data);
+        fmrb_spsc_ring_release(&g_cmd_ring);
+        applied++;
+    }
+    return applied;
+}
+
+// Coordinates of a command that can be recorded in a display list: `points`
+// x,y pairs at `offset`, repeated for each item of bulk commands
+typedef struct {
+    size_t offset;
+    size_t points;
+    size_t item_size;  // 0 = not a bulk command
+    bool wide;         // int32_t pairs instead of 16-bit
+    size_t min_size;   // Structure size (header size for bulk commands)
+} list_coords_t;
+
+static bool list_coords(uint8_t cmd_type, list_coords_t* c) {
+    *c = { 0, 0, 0, false, 0 };
+    switch (cmd_type) {
+        case FMRB_LINK_GFX_CLEAR:
+        case FMRB_LINK_GFX_FILL_SCREEN:
+            *c = { 0, 0, 0, false, sizeof(fmrb_link_graphics_clear_t) };
+            return true;  // Whole target, nothing to move
+        case FMRB_LINK_GFX_DRAW_PIXEL:
+            *c = { offsetof(fmrb_link_graphics_pixel_t, x), 1, 0, false, sizeof(fmrb_link_graphics_pixel_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_LINE:
+            *c = { offsetof(fmrb_link_graphics_line_t, x1), 2, 0, false, sizeof(fmrb_link_graphics_line_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_RECT:
+        case FMRB_LINK_GFX_FILL_RECT:
+            *c = { offsetof(fmrb_link_graphics_rect_t, x), 1, 0, false, sizeof(fmrb_link_graphics_rect_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_ROUND_RECT:
+        case FMRB_LINK_GFX_FILL_ROUND_RECT:
+            *c = { offsetof(fmrb_link_graphics_round_rect_t, x), 1, 0, false, sizeof(fmrb_link_graphics_round_rect_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_CIRCLE:
+        case FMRB_LINK_GFX_FILL_CIRCLE:
+            *c = { offsetof(fmrb_link_graphics_circle_t, x), 1, 0, false, sizeof(fmrb_link_graphics_circle_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_ELLIPSE:
+        case FMRB_LINK_GFX_FILL_ELLIPSE:
+            *c = { offsetof(fmrb_link_graphics_ellipse_t, x), 1, 0, false, sizeof(fmrb_link_graphics_ellipse_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_TRIANGLE:
+        case FMRB_LINK_GFX_FILL_TRIANGLE:
+            *c = { offsetof(fmrb_link_graphics_triangle_t, x0), 3, 0, false, sizeof(fmrb_link_graphics_triangle_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_STRING:
+            *c = { offsetof(fmrb_link_graphics_text_t, x), 1, 0, true, sizeof(fmrb_link_graphics_text_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_PIXELS:
+            *c = { sizeof(fmrb_link_graphics_bulk_t), 1, sizeof(fmrb_link_graphics_pixel_item_t), false, sizeof(fmrb_link_graphics_bulk_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_POLYLINE:
+            *c = { sizeof(fmrb_link_graphics_polyline_t), 1, sizeof(fmrb_link_graphics_point_item_t), false, sizeof(fmrb_link_graphics_polyline_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_LINES:
+            *c = { sizeof(fmrb_link_graphics_bulk_t), 2, sizeof(fmrb_link_graphics_line_item_t), false, sizeof(fmrb_link_graphics_bulk_t) };
+            return true;
+        case FMRB_LINK_GFX_FILL_RECTS:
+            *c = { sizeof(fmrb_link_graphics_bulk_t), 1, sizeof(fmrb_link_graphics_rect_item_t), false, sizeof(fmrb_link_graphics_bulk_t) };
+            return true;
+        case FMRB_LINK_GFX_DRAW_IMAGE:
+            *c = { offsetof(fmrb_link_graphics_draw_image_t, x), 1, 0, false,
+                   offsetof(fmrb_link_graphics_draw_image_t, src_x) };  // Source rectangle optional
+            return true;
+        case FMRB_LINK_GFX_DRAW_BITMAP:
+            *c = { offsetof(fmrb_link_graphics_draw_bitmap_t, x), 1, 0, false, sizeof(fmrb_link_graphics_draw_bitmap_t) };
+            return true;
+        case FMRB_LINK_GFX_CALL_LIST:
+            *c = { offsetof(fmrb_link_graphics_call_list_t, dx), 1, 0, false, sizeof(fmrb_link_graphics_call_list_t) };
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Add (dx, dy) to the coordinates of a recorded structure
+static void list_translate(const list_coords_t* c, uint8_t* data, size_t len, int32_t dx, int32_t dy) {
+    size_t pair = c->wide ? 2 * sizeof(int32_t) : 2 * sizeof(int16_t);
+    size_t items = 1;
+    size_t stride = 0;
+    if (len < c->offset) {
+        return;  // Too short; rejected when applied
+    }
+    if (c->item_size) {
+        uint16_t count;
+        memcpy(&count, data + offsetof(fmrb_link_graphics_bulk_t, count), sizeof(count));
+        items = std::min<size_t>(count, (len - c->offset) / c->item_size);
+        stride = c->item_size;
+    } else if (len < c->offset + c->points * pair) {
+        return;  // Too short; rejected when applied
+    }
+
+    for (size_t i = 0; i < items; i++) {
+        uint8_t* p = data + c->offset + i * stride;
+        for (size_t k = 0; k < c->points; k++, p += pair) {
+            if (c->wide) {
+                int32_t v[2];
+                memcpy(v, p, sizeof(v));
+                v[0] += dx;
+                v[1] += dy;
+                memcpy(p, v, sizeof(v));
+            } else {
+                int16_t v[2];  // Unsigned coordinate fields wrap the same way
+                memcpy(v, p, sizeof(v));
+                v[0] = (int16_t)(v[0] + dx);
+                v[1] = (int16_t)(v[1] + dy);
+                memcpy(p, v, sizeof(v));
+            }
+        }
     }
-    GFX_LOG_E("Canvas %u not found, using screen", g_current_target);
-    return g_lgfx;  // Fallback to screen
 }
 
-extern "C" int graphics_handler_init(void) {
-    // Prevent multiple initializations
-    if (g_graphics_initialized) {
-        GFX_LOG_E("Graphics handler already initialized, ignoring request");
-        return 0;  // Return success to avoid breaking caller
+// Append a drawing command to the list being recorded. A record shorter than its
+// structure fails the recording, so the error surfaces at END_LIST rather than
+// on every CALL_LIST.
+static int list_record(uint8_t cmd_type, const list_coords_t* coords, const uint8_t* data, size_t size) {
+    if (g_list_rec_failed) {
+        return -1;
     }
-
-    if (!g_lgfx) {
-        GFX_LOG_E("LGFX instance not created");
+    fmrb_link_graphics_batch_item_t item = { cmd_type, (uint16_t)size };
+    uint32_t need = g_list_rec.size + sizeof(item) + size;
+    if (size < coords->min_size || size > UINT16_MAX || need > DISPLAY_LIST_MAX_SIZE) {
+        GFX_LOG_E("Display list %u: cannot record cmd=0x%02x (size=%zu, list=%u bytes)",
+                  g_list_rec.list_id, cmd_type, size, (unsigned)g_list_rec.size);
+        g_list_rec_failed = true;
         return -1;
     }
 
-    g_lgfx->setAutoDisplay(false);
-
-    // Initialize cursor sprite (8x8 arrow)
-    g_cursor_sprite = new LGFX_Sprite(g_lgfx);
-    g_cursor_sprite->setColorDepth(8);  // 8-bit color
-    g_cursor_sprite->createSprite(8, 8);
-    g_cursor_sprite->clear(CURSOR_TRANSPARENT_COLOR);
-
-    // Draw cursor pattern
-    for (int y = 0; y < 8; y++) {
-        for (int x = 0; x < 8; x++) {
-            uint32_t color;
-            switch (cursor_pattern[y][x]) {
-                case 1: color = 0xFFFFFF; break;  // White outline
-                case 2: color = 0x000000; break;  // Black body
-                default: color = CURSOR_TRANSPARENT_COLOR; break;  // Transparent
-            }
-            g_cursor_sprite->drawPixel(x, y, color);
+    if (need > g_list_rec_capacity) {
+        uint32_t capacity = std::max<uint32_t>(g_list_rec_capacity * 2, 256);
+        capacity = std::min<uint32_t>(std::max(capacity, need), DISPLAY_LIST_MAX_SIZE);
+        uint8_t* grown = (uint8_t*)realloc(g_list_rec.data, capacity);
+        if (!grown) {
+            GFX_LOG_E("Display list %u: failed to grow to %u bytes", g_list_rec.list_id, (unsigned)capacity);
+            g_list_rec_failed = true;
+            return -1;
         }
+        g_list_rec.data = grown;
+        g_list_rec_capacity = capacity;
     }
 
-    g_graphics_initialized = true;  // Mark as initialized
-    GFX_LOG_I("Graphics handler initialized with screen buffer (%dx%d)",
-              (int)g_lgfx->width(), (int)g_lgfx->height());
-    GFX_LOG_I("Cursor sprite initialized (8x8) at position (%d, %d)", g_cursor_x, g_cursor_y);
+    memcpy(g_list_rec.data + g_list_rec.size, &item, sizeof(item));
+    memcpy(g_list_rec.data + g_list_rec.size + sizeof(item), data, size);
+    g_list_rec.size = need;
+    g_list_rec.count++;
+    g_list_rec.max_len = std::max<uint16_t>(g_list_rec.max_len, (uint16_t)size);
     return 0;
 }
 
-extern "C" void graphics_handler_cleanup(void) {
-    // Delete all canvases
-    while (g_canvas_count > 0) {
-        canvas_state_free(&g_canvases[0]);
+// END_LIST: store the recorded list, replacing one with the same ID
+static int list_end(uint16_t list_id) {
+    if (g_list_rec.list_id == 0 || g_list_rec.list_id != list_id) {
+        GFX_LOG_E("END_LIST %u without a matching BEGIN_LIST (recording %u)", list_id, g_list_rec.list_id);
+        return -1;
     }
-
-    // Delete cursor sprite
-    if (g_cursor_sprite) {
-        delete g_cursor_sprite;
-        g_cursor_sprite = nullptr;
-        GFX_LOG_I("Cursor sprite deleted");
+    if (g_list_rec_failed) {
+        GFX_LOG_E("Display list %u discarded (recording failed)", list_id);
+        list_discard_recording();
+        return -1;
     }
 
-    g_current_target = FMRB_CANVAS_SCREEN;
-    g_graphics_initialized = false;  // Reset initialization flag
+    display_list_t* list = list_find(list_id);
+    if (list) {
+        free(list->data);
+        *list = {};
+    }
+    if (g_list_rec.count == 0) {
+        list_discard_recording();
+        GFX_LOG_I("Display list %u deleted", list_id);
+        return 0;
+    }
+    if (!list && !(list = list_find(0))) {
+        GFX_LOG_E("Maximum display list count reached (%d)", MAX_DISPLAY_LISTS);
+        list_discard_recording();
+        return -1;
+    }
 
-    // Note: g_lgfx is managed by main.cpp, don't delete here
-    GFX_LOG_I("Graphics handler cleaned up");
+    *list = g_list_rec;
+    uint8_t* fitted = (uint8_t*)realloc(list->data, list->size);
+    if (fitted) {
+        list->data = fitted;
+    }
+    g_list_rec = {};
+    g_list_rec_capacity = 0;
+    GFX_LOG_I("Display list %u recorded: %u commands, %u bytes", list_id, list->count, (unsigned)list->size);
+    return 0;
 }
 
-// SDL_Renderer function removed - not needed in abstracted interface
+// CALL_LIST: replay a list from its recorded structures
+static int list_call(uint8_t msg_type, uint8_t seq, const uint8_t* data) {
+    // Copied first: data may be the scratch record of an enclosing replay
+    fmrb_link_graphics_call_list_t cmd;
+    memcpy(&cmd, data, sizeof(cmd));
 
-extern "C" void graphics_handler_render_frame(void) {
-    if (!g_lgfx) {
-        return;
+    const display_list_t* list = list_find(cmd.list_id);
+    if (cmd.list_id == 0 || !list) {
+        GFX_LOG_E("Display list %u not found", cmd.list_id);
+        return -1;
+    }
+    if (g_list_depth >= DISPLAY_LIST_MAX_DEPTH) {
+        GFX_LOG_E("Display list %u: calls nested too deep", cmd.list_id);
+        return -1;
+    }
+    for (int d = 0; d < g_list_depth; d++) {
+        if (g_list_stack[d] == cmd.list_id) {
+            GFX_LOG_E("Display list %u calls itself", cmd.list_id);
+            return -1;
+        }
+    }
+    if (list->max_len > g_list_scratch_size) {
+        uint8_t* grown = (uint8_t*)realloc(g_list_scratch, list->max_len);
+        if (!grown) {
+            GFX_LOG_E("Failed to allocate %u bytes to replay display list %u", list->max_len, cmd.list_id);
+            return -1;
+        }
+        g_list_scratch = grown;
+        g_list_scratch_size = list->max_len;
     }
-    graphics_handler_render_frame_internal();
-}
 
-// Use comm_interface send_ack function
-// (No forward declaration needed - using COMM_INTERFACE macro)
+    // Without cycles, lists calling other lists many times still fan out
+    // exponentially with the depth: all nested calls share one record budget
+    if (g_list_depth == 0) {
+        g_list_budget = DISPLAY_LIST_MAX_REPLAY;
+    }
+    g_list_stack[g_list_depth++] = cmd.list_id;
+    const uint8_t* p = list->data;
+    int failed = 0;
+    for (uint16_t i = 0; i < list->count; i++) {
+        if (g_list_budget == 0) {
+            GFX_LOG_E("CALL_LIST %u: replay limit of %d records reached, list cut short",
+                      cmd.list_id, DISPLAY_LIST_MAX_REPLAY);
+            failed++;
+            break;
+        }
+        g_list_budget--;
+
+        fmrb_link_graphics_batch_item_t item;
+        memcpy(&item, p, sizeof(item));
+        p += sizeof(item);
+
+        // Every recordable structure starts with its canvas_id
+        uint8_t* rec = g_list_scratch;
+        memcpy(rec, p, item.len);
+        memcpy(rec, &cmd.canvas_id, sizeof(cmd.canvas_id));
+        list_coords_t coords;
+        list_coords(item.cmd_type, &coords);
+        if (cmd.dx != 0 || cmd.dy != 0) {
+            list_translate(&coords, rec, item.len, cmd.dx, cmd.dy);
+        }
+        if (graphics_execute_command(msg_type, item.cmd_type, seq, rec, item.len) != 0) {
+            failed++;
+        }
+        p += item.len;
+    }
+    g_list_depth--;
 
-// Next canvas ID to allocate
-static uint16_t g_next_canvas_id = 1;
+    // Like BATCH, every command has run; the failure is still reported so a
+    // broken list does not look like a successful replay
+    if (failed) {
+        GFX_LOG_E("CALL_LIST %u: %d of %u commands failed", cmd.list_id, failed, list->count);
+        return -1;
+    }
+    return 0;
+}
 
-extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, const uint8_t *data, size_t size) {
+// Execute one command against the canvases (graphics task only)
+static int graphics_execute_command(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, const uint8_t *data, size_t size) {
     if (!g_lgfx) {
         return -1;
     }
@@ -346,6 +2122,12 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
     // cmd_type: graphics command type (from msgpack sub_cmd field)
     // data: structure data only (no cmd_type prefix)
 
+    // Drawing commands between BEGIN_LIST and END_LIST are recorded, not drawn
+    list_coords_t coords;
+    if (g_list_rec.list_id != 0 && list_coords(cmd_type, &coords)) {
+        return list_record(cmd_type, &coords, data, size);
+    }
+
     switch (cmd_type) {
         case FMRB_LINK_GFX_CLEAR:
         case FMRB_LINK_GFX_FILL_SCREEN:
@@ -355,20 +2137,21 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
 
                 // Get target from command (thread-safe)
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                     GFX_LOG_D("CLEAR: Using screen");
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                     GFX_LOG_D("CLEAR: Using canvas %u", cmd->canvas_id);
                 }
                 target->fillScreen(cmd->color);
+                target_mark_dirty(canvas, rect_make(0, 0, target->width(), target->height()));
                 GFX_LOG_D("CLEAR: fillScreen executed");
                 return 0;
             }
@@ -379,18 +2162,19 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 const fmrb_link_graphics_pixel_t *cmd = (const fmrb_link_graphics_pixel_t*)data;
                 // Get target from command (thread-safe)
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->drawPixel(cmd->x, cmd->y, cmd->color);
+                target_mark_dirty(canvas, rect_make(cmd->x, cmd->y, 1, 1));
                 return 0;
             }
             break;
@@ -400,18 +2184,20 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 const fmrb_link_graphics_line_t *cmd = (const fmrb_link_graphics_line_t*)data;
                 // Get target from command (thread-safe)
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->drawLine(cmd->x1, cmd->y1, cmd->x2, cmd->y2, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(std::min(cmd->x1, cmd->x2), std::min(cmd->y1, cmd->y2),
+                                                      std::max(cmd->x1, cmd->x2), std::max(cmd->y1, cmd->y2)));
                 return 0;
             }
             break;
@@ -421,18 +2207,19 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 const fmrb_link_graphics_rect_t *cmd = (const fmrb_link_graphics_rect_t*)data;
                 // Get target from command (thread-safe)
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->drawRect(cmd->x, cmd->y, cmd->width, cmd->height, cmd->color);
+                target_mark_dirty(canvas, rect_make(cmd->x, cmd->y, cmd->width, cmd->height));
                 return 0;
             }
             break;
@@ -444,20 +2231,21 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                        cmd->canvas_id, cmd->x, cmd->y, cmd->width, cmd->height, cmd->color);
                 // Get target from command (thread-safe)
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                     GFX_LOG_D("FILL_RECT: Using screen");
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                     GFX_LOG_D("FILL_RECT: Using canvas %u", cmd->canvas_id);
                 }
                 target->fillRect(cmd->x, cmd->y, cmd->width, cmd->height, cmd->color);
+                target_mark_dirty(canvas, rect_make(cmd->x, cmd->y, cmd->width, cmd->height));
                 GFX_LOG_D("FILL_RECT: fillRect executed");
                 return 0;
             }
@@ -467,18 +2255,19 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
             if (size >= sizeof(fmrb_link_graphics_round_rect_t)) {
                 const fmrb_link_graphics_round_rect_t *cmd = (const fmrb_link_graphics_round_rect_t*)data;
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->drawRoundRect(cmd->x, cmd->y, cmd->width, cmd->height, cmd->radius, cmd->color);
+                target_mark_dirty(canvas, rect_make(cmd->x, cmd->y, cmd->width, cmd->height));
                 return 0;
             }
             break;
@@ -487,18 +2276,19 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
             if (size >= sizeof(fmrb_link_graphics_round_rect_t)) {
                 const fmrb_link_graphics_round_rect_t *cmd = (const fmrb_link_graphics_round_rect_t*)data;
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->fillRoundRect(cmd->x, cmd->y, cmd->width, cmd->height, cmd->radius, cmd->color);
+                target_mark_dirty(canvas, rect_make(cmd->x, cmd->y, cmd->width, cmd->height));
                 return 0;
             }
             break;
@@ -509,20 +2299,21 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 GFX_LOG_D("DRAW_CIRCLE: canvas_id=%u, x=%d, y=%d, r=%d, color=0x%02x",
                        cmd->canvas_id, cmd->x, cmd->y, cmd->radius, cmd->color);
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                     GFX_LOG_D("DRAW_CIRCLE: Using screen");
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                     GFX_LOG_D("DRAW_CIRCLE: Using canvas %u", cmd->canvas_id);
                 }
                 target->drawCircle(cmd->x, cmd->y, cmd->radius, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(cmd->x - cmd->radius, cmd->y - cmd->radius, cmd->x + cmd->radius, cmd->y + cmd->radius));
                 GFX_LOG_D("DRAW_CIRCLE: drawCircle executed");
                 return 0;
             }
@@ -534,20 +2325,21 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 GFX_LOG_D("FILL_CIRCLE: canvas_id=%u, x=%d, y=%d, r=%d, color=0x%02x",
                        cmd->canvas_id, cmd->x, cmd->y, cmd->radius, cmd->color);
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                     GFX_LOG_D("FILL_CIRCLE: Using screen");
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                     GFX_LOG_D("FILL_CIRCLE: Using canvas %u", cmd->canvas_id);
                 }
                 target->fillCircle(cmd->x, cmd->y, cmd->radius, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(cmd->x - cmd->radius, cmd->y - cmd->radius, cmd->x + cmd->radius, cmd->y + cmd->radius));
                 GFX_LOG_D("FILL_CIRCLE: fillCircle executed");
                 return 0;
             }
@@ -557,18 +2349,19 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
             if (size >= sizeof(fmrb_link_graphics_ellipse_t)) {
                 const fmrb_link_graphics_ellipse_t *cmd = (const fmrb_link_graphics_ellipse_t*)data;
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->drawEllipse(cmd->x, cmd->y, cmd->rx, cmd->ry, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(cmd->x - cmd->rx, cmd->y - cmd->ry, cmd->x + cmd->rx, cmd->y + cmd->ry));
                 return 0;
             }
             break;
@@ -577,18 +2370,19 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
             if (size >= sizeof(fmrb_link_graphics_ellipse_t)) {
                 const fmrb_link_graphics_ellipse_t *cmd = (const fmrb_link_graphics_ellipse_t*)data;
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->fillEllipse(cmd->x, cmd->y, cmd->rx, cmd->ry, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(cmd->x - cmd->rx, cmd->y - cmd->ry, cmd->x + cmd->rx, cmd->y + cmd->ry));
                 return 0;
             }
             break;
@@ -597,18 +2391,20 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
             if (size >= sizeof(fmrb_link_graphics_triangle_t)) {
                 const fmrb_link_graphics_triangle_t *cmd = (const fmrb_link_graphics_triangle_t*)data;
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->drawTriangle(cmd->x0, cmd->y0, cmd->x1, cmd->y1, cmd->x2, cmd->y2, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(std::min({cmd->x0, cmd->x1, cmd->x2}), std::min({cmd->y0, cmd->y1, cmd->y2}),
+                                                      std::max({cmd->x0, cmd->x1, cmd->x2}), std::max({cmd->y0, cmd->y1, cmd->y2})));
                 return 0;
             }
             break;
@@ -617,18 +2413,20 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
             if (size >= sizeof(fmrb_link_graphics_triangle_t)) {
                 const fmrb_link_graphics_triangle_t *cmd = (const fmrb_link_graphics_triangle_t*)data;
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                    canvas = canvas_state_find(cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                 }
                 target->fillTriangle(cmd->x0, cmd->y0, cmd->x1, cmd->y1, cmd->x2, cmd->y2, cmd->color);
+                target_mark_dirty(canvas, rect_bounds(std::min({cmd->x0, cmd->x1, cmd->x2}), std::min({cmd->y0, cmd->y1, cmd->y2}),
+                                                      std::max({cmd->x0, cmd->x1, cmd->x2}), std::max({cmd->y0, cmd->y1, cmd->y2})));
                 return 0;
             }
             break;
@@ -662,20 +2460,32 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
 
                 // Get target from command
                 LovyanGFX* target;
+                canvas_state_t* canvas = nullptr;
                 if (text_cmd->canvas_id == FMRB_CANVAS_SCREEN) {
                     target = g_lgfx;
                     GFX_LOG_D("DRAW_STRING: Using screen");
                 } else {
-                    canvas_state_t* canvas = canvas_state_find(text_cmd->canvas_id);
+                    canvas = canvas_state_find(text_cmd->canvas_id);
                     if (!canvas) {
                         GFX_LOG_E("Canvas %u not found", text_cmd->canvas_id);
                         return -1;
                     }
                     target = canvas->draw_buffer;
-                    canvas->dirty = true;
                     GFX_LOG_D("DRAW_STRING: Using canvas %u", text_cmd->canvas_id);
                 }
 
+                // Single-line ASCII runs on a canvas are blitted from the glyph atlas
+                int32_t run_w;
+                if (canvas && glyph_atlas_draw((uint8_t*)canvas->draw_buffer_mem, canvas->active_width,
+                                               canvas->active_width, canvas->active_height,
+                                               text_cmd->x, text_cmd->y, text_data, len, text_cmd->color,
+                                               text_cmd->bg_transparent ? -1 : text_cmd->bg_color, &run_w) == 0) {
+                    target->setCursor(text_cmd->x + run_w, text_cmd->y);
+                    target_mark_dirty(canvas, rect_make(text_cmd->x, text_cmd->y, run_w, glyph_atlas_height()));
+                    GFX_LOG_D("DRAW_STRING: Text drawn from glyph atlas");
+                    return 0;
+                }
+
                 // Set text color with optional background
                 if (text_cmd->bg_transparent) {
                     // Foreground only (transparent background)
@@ -687,68 +2497,340 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
 
                 target->setCursor(text_cmd->x, text_cmd->y);
                 target->print(text_buf);
+
+                // Text extent from the cursor movement; wrapped or multi-line text dirties full rows
+                int32_t end_x = target->getCursorX();
+                int32_t end_y = target->getCursorY();
+                int32_t font_h = target->fontHeight();
+                if (end_y == text_cmd->y) {
+                    target_mark_dirty(canvas, rect_make(text_cmd->x, text_cmd->y, end_x - text_cmd->x, font_h));
+                } else {
+                    target_mark_dirty(canvas, rect_make(0, text_cmd->y, target->width(), end_y - text_cmd->y + font_h));
+                }
                 GFX_LOG_D("DRAW_STRING: Text drawn");
                 return 0;
             }
 
-        // case FMRB_LINK_GFX_PRESENT:
-        //     if (size >= sizeof(fmrb_link_graphics_present_t)) {
-        //         const fmrb_link_graphics_present_t *cmd = (const fmrb_link_graphics_present_t*)data;
-        //         GFX_LOG_D("PRESENT: canvas_id=%u", cmd->canvas_id);
+        case FMRB_LINK_GFX_PRESENT:
+            if (size >= offsetof(fmrb_link_graphics_present_t, flags)) {
+                fmrb_link_graphics_present_t cmd = {};
+                memcpy(&cmd, data, std::min(size, sizeof(cmd)));  // flags are optional
+                GFX_LOG_D("PRESENT: canvas_id=%u, flags=0x%02x", cmd.canvas_id, cmd.flags);
+
+                if (cmd.canvas_id == FMRB_CANVAS_SCREEN) {
+                    // Direct screen update - nothing to do, main loop handles rendering
+                    GFX_LOG_D("PRESENT: Screen - will be rendered in main loop");
+                    return 0;
+                }
+
+                canvas_state_t* canvas = canvas_state_find(cmd.canvas_id);
+                if (!canvas) {
+                    GFX_LOG_E("Canvas %u not found for present", cmd.canvas_id);
+                    return -1;
+                }
+
+                // Note: Rendering and display() are handled by main loop at ~60fps
+                return canvas_swap_present(canvas, (cmd.flags & FMRB_LINK_PRESENT_PRESERVE) != 0);
+            }
+            break;
+
+        // Bulk drawing commands: the target is resolved once, the dirty area is the items' bounds
+        case FMRB_LINK_GFX_DRAW_PIXELS:
+            if (size >= sizeof(fmrb_link_graphics_bulk_t)) {
+                const fmrb_link_graphics_bulk_t *cmd = (const fmrb_link_graphics_bulk_t*)data;
+                const uint8_t* p = bulk_items(data, size, sizeof(*cmd), cmd->count, sizeof(fmrb_link_graphics_pixel_item_t));
+                canvas_state_t* canvas;
+                LovyanGFX* target = target_resolve(cmd->canvas_id, &canvas);
+                if (!p || !target) {
+                    return -1;
+                }
+
+                gfx_rect_t dirty;
+                rect_clear(&dirty);
+                if (canvas) {
+                    // Plot straight into the draw buffer
+                    uint8_t* mem = (uint8_t*)canvas->draw_buffer_mem;
+                    uint32_t w = canvas->active_width;
+                    uint32_t h = canvas->active_height;
+                    for (uint16_t i = 0; i < cmd->count; i++, p += sizeof(fmrb_link_graphics_pixel_item_t)) {
+                        fmrb_link_graphics_pixel_item_t item;
+                        memcpy(&item, p, sizeof(item));
+                        if ((uint32_t)item.x < w && (uint32_t)item.y < h) {
+                            mem[item.y * w + item.x] = item.color;
+                            rect_include(&dirty, item.x, item.y);
+                        }
+                    }
+                } else {
+                    target->startWrite();
+                    for (uint16_t i = 0; i < cmd->count; i++, p += sizeof(fmrb_link_graphics_pixel_item_t)) {
+                        fmrb_link_graphics_pixel_item_t item;
+                        memcpy(&item, p, sizeof(item));
+                        target->drawPixel(item.x, item.y, item.color);
+                        rect_include(&dirty, item.x, item.y);
+                    }
+                    target->endWrite();
+                }
+                target_mark_dirty(canvas, dirty);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_DRAW_POLYLINE:
+            if (size >= sizeof(fmrb_link_graphics_polyline_t)) {
+                const fmrb_link_graphics_polyline_t *cmd = (const fmrb_link_graphics_polyline_t*)data;
+                const uint8_t* p = bulk_items(data, size, sizeof(*cmd), cmd->count, sizeof(fmrb_link_graphics_point_item_t));
+                canvas_state_t* canvas;
+                LovyanGFX* target = target_resolve(cmd->canvas_id, &canvas);
+                if (!p || !target) {
+                    return -1;
+                }
+                if (cmd->count == 0) {
+                    return 0;
+                }
+
+                fmrb_link_graphics_point_item_t prev;
+                memcpy(&prev, p, sizeof(prev));
+                gfx_rect_t dirty = rect_make(prev.x, prev.y, 1, 1);
+                target->startWrite();
+                if (cmd->count == 1) {
+                    target->drawPixel(prev.x, prev.y, cmd->color);
+                }
+                for (uint16_t i = 1; i < cmd->count; i++) {
+                    fmrb_link_graphics_point_item_t pt;
+                    memcpy(&pt, p + i * sizeof(pt), sizeof(pt));
+                    target->drawLine(prev.x, prev.y, pt.x, pt.y, cmd->color);
+                    rect_include(&dirty, pt.x, pt.y);
+                    prev = pt;
+                }
+                target->endWrite();
+                target_mark_dirty(canvas, dirty);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_DRAW_LINES:
+            if (size >= sizeof(fmrb_link_graphics_bulk_t)) {
+                const fmrb_link_graphics_bulk_t *cmd = (const fmrb_link_graphics_bulk_t*)data;
+                const uint8_t* p = bulk_items(data, size, sizeof(*cmd), cmd->count, sizeof(fmrb_link_graphics_line_item_t));
+                canvas_state_t* canvas;
+                LovyanGFX* target = target_resolve(cmd->canvas_id, &canvas);
+                if (!p || !target) {
+                    return -1;
+                }
+
+                gfx_rect_t dirty;
+                rect_clear(&dirty);
+                target->startWrite();
+                for (uint16_t i = 0; i < cmd->count; i++, p += sizeof(fmrb_link_graphics_line_item_t)) {
+                    fmrb_link_graphics_line_item_t item;
+                    memcpy(&item, p, sizeof(item));
+                    target->drawLine(item.x1, item.y1, item.x2, item.y2, item.color);
+                    rect_include(&dirty, item.x1, item.y1);
+                    rect_include(&dirty, item.x2, item.y2);
+                }
+                target->endWrite();
+                target_mark_dirty(canvas, dirty);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_FILL_RECTS:
+            if (size >= sizeof(fmrb_link_graphics_bulk_t)) {
+                const fmrb_link_graphics_bulk_t *cmd = (const fmrb_link_graphics_bulk_t*)data;
+                const uint8_t* p = bulk_items(data, size, sizeof(*cmd), cmd->count, sizeof(fmrb_link_graphics_rect_item_t));
+                canvas_state_t* canvas;
+                LovyanGFX* target = target_resolve(cmd->canvas_id, &canvas);
+                if (!p || !target) {
+                    return -1;
+                }
+
+                gfx_rect_t dirty;
+                rect_clear(&dirty);
+                if (canvas) {
+                    // Clip and fill straight into the draw buffer
+                    gfx_rect_t active = { 0, 0, canvas->active_width, canvas->active_height };
+                    size_t stride = canvas->active_width;
+                    for (uint16_t i = 0; i < cmd->count; i++, p += sizeof(fmrb_link_graphics_rect_item_t)) {
+                        fmrb_link_graphics_rect_item_t item;
+                        memcpy(&item, p, sizeof(item));
+                        gfx_rect_t r = rect_make(item.x, item.y, item.width, item.height);
+                        if (rect_intersect(&r, &active)) {
+                            fmrb_blit8_fill((uint8_t*)canvas->draw_buffer_mem + r.y0 * stride + r.x0, stride,
+                                            r.x1 - r.x0, r.y1 - r.y0, item.color);
+                            rect_union(&dirty, &r);
+                        }
+                    }
+                } else {
+                    target->startWrite();
+                    for (uint16_t i = 0; i < cmd->count; i++, p += sizeof(fmrb_link_graphics_rect_item_t)) {
+                        fmrb_link_graphics_rect_item_t item;
+                        memcpy(&item, p, sizeof(item));
+                        target->fillRect(item.x, item.y, item.width, item.height, item.color);
+                        gfx_rect_t r = rect_make(item.x, item.y, item.width, item.height);
+                        rect_union(&dirty, &r);
+                    }
+                    target->endWrite();
+                }
+                target_mark_dirty(canvas, dirty);
+                return 0;
+            }
+            break;
+
+        // Image store commands
+        case FMRB_LINK_GFX_CREATE_IMAGE_FROM_MEM:
+            if (size >= sizeof(fmrb_link_graphics_create_image_t)) {
+                const fmrb_link_graphics_create_image_t *cmd = (const fmrb_link_graphics_create_image_t*)data;
+                if (cmd->data_len > size - sizeof(*cmd)) {
+                    GFX_LOG_E("CREATE_IMAGE: image %u truncated (%u bytes, %zu received)",
+                              cmd->image_id, (unsigned)cmd->data_len, size - sizeof(*cmd));
+                    return -1;
+                }
+
+                // A failed upload leaves an existing image with this ID untouched
+                uint8_t* pixels = image_decode(cmd->image_id, cmd->width, cmd->height, data + sizeof(*cmd),
+                                               cmd->data_len, cmd->format == FMRB_LINK_IMAGE_FORMAT_ENCODED);
+                if (!pixels || image_install(cmd->image_id, cmd->width, cmd->height, pixels) < 0) {
+                    return -1;
+                }
+                image_changed(cmd->image_id);
+                GFX_LOG_I("Image created: ID=%u, %dx%d, format=%u", cmd->image_id,
+                          cmd->width, cmd->height, cmd->format);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_CREATE_IMAGE_FROM_FILE:
+            if (size >= sizeof(fmrb_link_graphics_create_image_file_t)) {
+                const fmrb_link_graphics_create_image_file_t *cmd = (const fmrb_link_graphics_create_image_file_t*)data;
+                if (cmd->path_len > size - sizeof(*cmd)) {
+                    GFX_LOG_E("CREATE_IMAGE_FROM_FILE: path truncated");
+                    return -1;
+                }
+                char path[256];
+                size_t path_len = std::min((size_t)cmd->path_len, sizeof(path) - 1);
+                memcpy(path, data + sizeof(*cmd), path_len);
+                path[path_len] = '\0';
+
+                FILE* fp = fopen(path, "rb");
+                if (!fp) {
+                    GFX_LOG_E("CREATE_IMAGE_FROM_FILE: cannot open %s", path);
+                    return -1;
+                }
+                fseek(fp, 0, SEEK_END);
+                long file_len = ftell(fp);
+                fseek(fp, 0, SEEK_SET);
+                uint8_t* file_data = file_len > 0 ? (uint8_t*)malloc(file_len) : nullptr;
+                size_t read_len = file_data ? fread(file_data, 1, file_len, fp) : 0;
+                fclose(fp);
+                if (!file_data || read_len != (size_t)file_len) {
+                    GFX_LOG_E("CREATE_IMAGE_FROM_FILE: failed to read %s", path);
+                    free(file_data);
+                    return -1;
+                }
+
+                // Headerless files of exactly width * height bytes are raw RGB332
+                bool encoded = read_len != (size_t)cmd->width * cmd->height;
+                uint8_t* pixels = image_decode(cmd->image_id, cmd->width, cmd->height, file_data, read_len, encoded);
+                free(file_data);
+                int ret = pixels ? image_install(cmd->image_id, cmd->width, cmd->height, pixels) : -1;
+                if (ret == 0) {
+                    image_changed(cmd->image_id);
+                    GFX_LOG_I("Image created: ID=%u, %dx%d, from %s", cmd->image_id, cmd->width, cmd->height, path);
+                }
+                return ret;
+            }
+            break;
+
+        case FMRB_LINK_GFX_DELETE_IMAGE:
+            if (size >= sizeof(fmrb_link_graphics_delete_image_t)) {
+                const fmrb_link_graphics_delete_image_t *cmd = (const fmrb_link_graphics_delete_image_t*)data;
+                image_entry_t* image = image_find(cmd->image_id);
+                if (!image) {
+                    GFX_LOG_E("Image %u not found", cmd->image_id);
+                    return -1;
+                }
+                image_delete(image);
+                image_changed(cmd->image_id);
+                GFX_LOG_I("Image deleted: ID=%u", cmd->image_id);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_DRAW_IMAGE:
+            if (size >= offsetof(fmrb_link_graphics_draw_image_t, src_x)) {
+                fmrb_link_graphics_draw_image_t cmd = {};
+                memcpy(&cmd, data, std::min(size, sizeof(cmd)));  // Source rectangle is optional
 
-        //         if (cmd->canvas_id == FMRB_CANVAS_SCREEN) {
-        //             // Direct screen update - nothing to do, main loop handles rendering
-        //             GFX_LOG_D("PRESENT: Screen - will be rendered in main loop");
-        //         } else {
-        //             // Push draw_buffer to render_buffer for the specified canvas
-        //             canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
-        //             if (!canvas) {
-        //                 GFX_LOG_E("Canvas %u not found for present", cmd->canvas_id);
-        //                 return -1;
-        //             }
+                const image_entry_t* image = image_find(cmd.image_id);
+                if (!image) {
+                    GFX_LOG_E("Image %u not found", cmd.image_id);
+                    return -1;
+                }
+                canvas_state_t* canvas = nullptr;
+                if (cmd.canvas_id != FMRB_CANVAS_SCREEN) {
+                    canvas = canvas_state_find(cmd.canvas_id);
+                    if (!canvas) {
+                        GFX_LOG_E("Canvas %u not found", cmd.canvas_id);
+                        return -1;
+                    }
+                }
 
-        //             // Copy draw_buffer to render_buffer (double buffering)
-        //             GFX_LOG_D("PRESENT: Copying draw_buffer to render_buffer for canvas %u", cmd->canvas_id);
-        //             canvas->draw_buffer->pushSprite(canvas->render_buffer, 0, 0);
-        //             canvas->dirty = true;
-        //         }
+                // Clip the source rectangle to the image
+                gfx_rect_t src = rect_make(cmd.src_x, cmd.src_y,
+                                           cmd.src_w ? cmd.src_w : image->width - cmd.src_x,
+                                           cmd.src_h ? cmd.src_h : image->height - cmd.src_y);
+                gfx_rect_t bounds = { 0, 0, image->width, image->height };
+                if (!rect_intersect(&src, &bounds)) {
+                    return 0;
+                }
+                target_draw_pixels8(canvas, cmd.x + (src.x0 - cmd.src_x), cmd.y + (src.y0 - cmd.src_y),
+                                    image->pixels + src.y0 * image->width + src.x0, image->width,
+                                    src.x1 - src.x0, src.y1 - src.y0,
+                                    cmd.use_transparency ? cmd.transparent_color : CANVAS_PRESENT_OPAQUE);
+                GFX_LOG_D("DRAW_IMAGE: image %u to canvas %u at (%d,%d)", cmd.image_id, cmd.canvas_id, cmd.x, cmd.y);
+                return 0;
+            }
+            break;
 
-        //         // Note: Rendering and display() are handled by main loop at ~60fps
-        //         GFX_LOG_D("PRESENT: Canvas updated, will be rendered in main loop");
-        //         return 0;
-        //     }
-        //     break;
+        case FMRB_LINK_GFX_DRAW_BITMAP:
+            if (size >= sizeof(fmrb_link_graphics_draw_bitmap_t)) {
+                const fmrb_link_graphics_draw_bitmap_t *cmd = (const fmrb_link_graphics_draw_bitmap_t*)data;
+                if ((size_t)cmd->width * cmd->height > size - sizeof(*cmd)) {
+                    GFX_LOG_E("DRAW_BITMAP: %dx%d pixels truncated", cmd->width, cmd->height);
+                    return -1;
+                }
+                canvas_state_t* canvas = nullptr;
+                if (cmd->canvas_id != FMRB_CANVAS_SCREEN) {
+                    canvas = canvas_state_find(cmd->canvas_id);
+                    if (!canvas) {
+                        GFX_LOG_E("Canvas %u not found", cmd->canvas_id);
+                        return -1;
+                    }
+                }
+                target_draw_pixels8(canvas, cmd->x, cmd->y, data + sizeof(*cmd), cmd->width,
+                                    cmd->width, cmd->height,
+                                    cmd->use_transparency ? cmd->transparent_color : CANVAS_PRESENT_OPAQUE);
+                return 0;
+            }
+            break;
 
         // Canvas management commands
         case FMRB_LINK_GFX_CREATE_CANVAS:
             if (size >= sizeof(fmrb_link_graphics_create_canvas_t)) {
                 const fmrb_link_graphics_create_canvas_t *cmd = (const fmrb_link_graphics_create_canvas_t*)data;
 
-                // Allocate new canvas ID (ignore cmd->canvas_id from client)
-                uint16_t canvas_id = g_next_canvas_id++;
-                if (canvas_id == 0xFFFF) {  // FMRB_CANVAS_INVALID
-                    canvas_id = g_next_canvas_id++;  // Skip invalid value
-                }
+                // canvas_id was assigned (and acknowledged) when the command was queued
+                uint16_t canvas_id = cmd->canvas_id;
 
-                // Allocate canvas state
-                canvas_state_t* canvas = canvas_state_alloc(canvas_id, cmd->width, cmd->height);
+                // Allocate canvas state with z_order from Core
+                canvas_state_t* canvas = canvas_state_alloc(canvas_id, cmd->width, cmd->height, cmd->z_order);
                 if (!canvas) {
                     GFX_LOG_E("Failed to allocate canvas %u (%dx%d)",
                             canvas_id, (int)cmd->width, (int)cmd->height);
                     return -1;
                 }
 
-                // Override z_order with value from Core
-                canvas->z_order = cmd->z_order;
-
                 GFX_LOG_I("Canvas created: ID=%u, %dx%d, z_order=%d", canvas_id, (int)cmd->width, (int)cmd->height, (int)cmd->z_order);
-
-                // Send ACK with canvas_id
-#if defined(CONFIG_IDF_TARGET_LINUX) || defined(LGFX_USE_SDL)
-                socket_server_send_ack(msg_type, seq, (const uint8_t*)&canvas_id, sizeof(canvas_id));
-#else
-                COMM_INTERFACE->send_ack(msg_type, seq, (const uint8_t*)&canvas_id, sizeof(canvas_id));
-#endif
                 return 0;
             }
             break;
@@ -784,8 +2866,8 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                     return -1;
                 }
 
-                // Update z_order
-                canvas->z_order = cmd->z_order;
+                // Update z_order (the index is re-sorted before the next frame)
+                canvas_set_zorder(canvas, cmd->z_order);
                 GFX_LOG_I("Canvas %u z_order updated to %d", cmd->canvas_id, cmd->z_order);
                 return 0;
             }
@@ -804,26 +2886,41 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 GFX_LOG_I("UPDATE_WINDOW: canvas_id=%u, pos=(%d,%d), active_size=%dx%d",
                           cmd->canvas_id, (int)cmd->x, (int)cmd->y, (int)cmd->width, (int)cmd->height);
 
+                // Grow the buffers first so a failed allocation leaves the canvas unchanged
+                if (canvas_reserve_buffers(canvas, (uint16_t)cmd->width, (uint16_t)cmd->height) < 0) {
+                    return -1;
+                }
+
+                // Old screen area is exposed; the new one is marked below
+                canvas_mark_exposed(canvas);
+                bool resized = canvas->active_width != (uint16_t)cmd->width ||
+                               canvas->active_height != (uint16_t)cmd->height;
+
                 // Update position
                 canvas->push_x = cmd->x;
                 canvas->push_y = cmd->y;
 
                 // Update active size by calling setBuffer with new dimensions
-                // This reuses the same external memory buffer with new width/height
+                // This reuses the external memory buffers unless they had to grow
                 canvas->active_width = (uint16_t)cmd->width;
                 canvas->active_height = (uint16_t)cmd->height;
 
-                // Reconfigure sprites with new dimensions (reusing same memory buffers)
+                // Reconfigure sprites with new dimensions
                 canvas->draw_buffer->setBuffer(canvas->draw_buffer_mem,
                                               canvas->active_width, canvas->active_height, 8);
                 canvas->render_buffer->setBuffer(canvas->render_buffer_mem,
                                                 canvas->active_width, canvas->active_height, 8);
 
-                GFX_LOG_I("Canvas %u resized to %dx%d using setBuffer (allocated: %dx%d)",
+                GFX_LOG_I("Canvas %u resized to %dx%d using setBuffer (buffer_capacity: %u)",
                           cmd->canvas_id, canvas->active_width, canvas->active_height,
-                          canvas->width, canvas->height);
+                          (unsigned)canvas->buffer_capacity);
 
-                canvas->dirty = true;
+                if (resized) {
+                    // The buffers are reinterpreted with the new stride: copy all of draw_buffer on the next present
+                    canvas->present_key = CANVAS_PRESENT_STALE;
+                    rect_clear(&canvas->dirty);
+                }
+                canvas_mark_exposed(canvas);
                 return 0;
             }
             break;
@@ -864,14 +2961,7 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 int push_x, push_y;
 
                 if (cmd->dest_canvas_id == FMRB_CANVAS_RENDER) {
-                    // Push to own render_buffer at (0,0), save position for later screen rendering
-                    dst = src_canvas->render_buffer;
-                    dst_name = "render_canvas";
-                    src_canvas->push_x = cmd->x;
-                    src_canvas->push_y = cmd->y;
-                    src_canvas->is_visible = true;  // Make visible on first present()
-                    push_x = 0;
-                    push_y = 0;
+                    return canvas_present(src_canvas, cmd);
                 } else if(cmd->dest_canvas_id == 0) {
                     // Push directly to screen at specified position
                     dst = g_lgfx;
@@ -888,22 +2978,115 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
                 }
 
 
-                // Push draw_buffer to destination
-                LGFX_Sprite* src_sprite = src_canvas->draw_buffer;
+                // Push the active region of draw_buffer, keyed like the compositor
                 GFX_LOG_D("PUSH_CANVAS: src=%p (active=%dx%d), dst=%p (%s), push_at=(%d,%d), save_pos=(%d,%d)",
-                       src_sprite, src_canvas->active_width, src_canvas->active_height, dst, dst_name,
+                       src_canvas->draw_buffer, src_canvas->active_width, src_canvas->active_height, dst, dst_name,
                        push_x, push_y, (int)cmd->x, (int)cmd->y);
+                target_draw_pixels8(nullptr, push_x, push_y, (const uint8_t*)src_canvas->draw_buffer_mem,
+                                    src_canvas->active_width, src_canvas->active_width, src_canvas->active_height,
+                                    cmd->use_transparency ? cmd->transparent_color : CANVAS_PRESENT_OPAQUE);
+                GFX_LOG_D("Canvas pushed: ID=%u to %s at (%d,%d), transp=%s", cmd->canvas_id, dst_name,
+                          push_x, push_y, cmd->use_transparency ? "yes" : "no");
+                return 0;
+            }
+            break;
 
-                // Since setBuffer configures sprite to active size, pushSprite transfers only active region
-                if (cmd->use_transparency) {
-                    src_sprite->pushSprite(dst, push_x, push_y, cmd->transparent_color);
-                    GFX_LOG_D("Canvas pushed with transparency: ID=%u to %s at (%d,%d), transp=0x%02x",
-                           cmd->canvas_id, dst_name, push_x, push_y, cmd->transparent_color);
-                } else {
-                    src_sprite->pushSprite(dst, push_x, push_y);
-                    GFX_LOG_D("Canvas pushed: ID=%u to %s at (%d,%d)", cmd->canvas_id, dst_name, push_x, push_y);
+        case FMRB_LINK_GFX_SET_TILEMAP:
+            if (size >= sizeof(fmrb_link_graphics_set_tilemap_t)) {
+                const fmrb_link_graphics_set_tilemap_t *cmd = (const fmrb_link_graphics_set_tilemap_t*)data;
+                canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                if (!canvas) {
+                    GFX_LOG_E("Canvas %u not found for SET_TILEMAP", cmd->canvas_id);
+                    return -1;
+                }
+                GFX_LOG_I("SET_TILEMAP: canvas %u, sheet=%u, tile=%dx%d, map=%dx%d", cmd->canvas_id,
+                          cmd->image_id, cmd->tile_w, cmd->tile_h, cmd->map_w, cmd->map_h);
+                return tilemap_set(canvas, cmd);
+            }
+            break;
+
+        case FMRB_LINK_GFX_SET_TILES:
+            if (size >= sizeof(fmrb_link_graphics_set_tiles_t)) {
+                const fmrb_link_graphics_set_tiles_t *cmd = (const fmrb_link_graphics_set_tiles_t*)data;
+                canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                if (!canvas || !canvas->tilemap) {
+                    GFX_LOG_E("No tilemap on canvas %u for SET_TILES", cmd->canvas_id);
+                    return -1;
+                }
+                tilemap_t* tm = canvas->tilemap;
+                size_t cells = (size_t)cmd->width * cmd->height;
+                if ((size - sizeof(*cmd)) / sizeof(uint16_t) < cells ||
+                    cmd->x + cmd->width > tm->map_w || cmd->y + cmd->height > tm->map_h) {
+                    GFX_LOG_E("SET_TILES: invalid area (%d,%d) %dx%d on a %dx%d map (size=%zu)",
+                              cmd->x, cmd->y, cmd->width, cmd->height, tm->map_w, tm->map_h, size);
+                    return -1;
+                }
+
+                const uint8_t* src = data + sizeof(*cmd);
+                for (uint16_t row = 0; row < cmd->height; row++) {
+                    memcpy(tm->tiles + (cmd->y + row) * tm->map_w + cmd->x,
+                           src + (size_t)row * cmd->width * sizeof(uint16_t), cmd->width * sizeof(uint16_t));
+                }
+                canvas_mark_exposed(canvas);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_SET_SCROLL:
+            if (size >= sizeof(fmrb_link_graphics_set_scroll_t)) {
+                const fmrb_link_graphics_set_scroll_t *cmd = (const fmrb_link_graphics_set_scroll_t*)data;
+                canvas_state_t* canvas = canvas_state_find(cmd->canvas_id);
+                if (!canvas || !canvas->tilemap) {
+                    GFX_LOG_E("No tilemap on canvas %u for SET_SCROLL", cmd->canvas_id);
+                    return -1;
+                }
+                tilemap_t* tm = canvas->tilemap;
+                if (tm->scroll_x != cmd->scroll_x || tm->scroll_y != cmd->scroll_y) {
+                    tm->scroll_x = cmd->scroll_x;
+                    tm->scroll_y = cmd->scroll_y;
+                    canvas_mark_exposed(canvas);
+                }
+                GFX_LOG_D("SET_SCROLL: canvas %u scroll=(%d,%d)", cmd->canvas_id, (int)cmd->scroll_x, (int)cmd->scroll_y);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_SET_SPRITES:
+            if (size >= sizeof(fmrb_link_graphics_set_sprites_t)) {
+                const fmrb_link_graphics_set_sprites_t *cmd = (const fmrb_link_graphics_set_sprites_t*)data;
+                const uint8_t* items = bulk_items(data, size, sizeof(*cmd), cmd->count,
+                                                  sizeof(fmrb_link_graphics_sprite_item_t));
+                if (!items) {
+                    return -1;
+                }
+                for (uint16_t i = 0; i < cmd->count; i++) {
+                    fmrb_link_graphics_sprite_item_t item;
+                    memcpy(&item, items + i * sizeof(item), sizeof(item));
+                    if (item.index >= FMRB_LINK_SPRITE_COUNT) {
+                        GFX_LOG_E("Sprite index %u out of range", item.index);
+                        continue;
+                    }
+                    gfx_sprite_t* sprite = &g_sprites[item.index];
+                    sprite->image_id = item.image_id;
+                    sprite->x = item.x;
+                    sprite->y = item.y;
+                    sprite->flags = item.flags;
+                    sprite->priority = item.priority;
+                    sprite_refresh(sprite);
                 }
+                GFX_LOG_D("SET_SPRITES: %u sprites", cmd->count);
+                return 0;
+            }
+            break;
 
+        case FMRB_LINK_GFX_SPRITE_CONFIG:
+            if (size >= sizeof(fmrb_link_graphics_sprite_config_t)) {
+                const fmrb_link_graphics_sprite_config_t *cmd = (const fmrb_link_graphics_sprite_config_t*)data;
+                sprites_mark_all_dirty();
+                g_sprite_key = cmd->transparent_color;
+                g_sprite_line_limit = cmd->line_limit;
+                sprites_mark_all_dirty();
+                GFX_LOG_I("Sprite config: transparent=0x%02X, line_limit=%u", g_sprite_key, g_sprite_line_limit);
                 return 0;
             }
             break;
@@ -911,8 +3094,10 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
         case FMRB_LINK_GFX_CURSOR_SET_POSITION:
             if (size >= sizeof(fmrb_link_graphics_cursor_position_t)) {
                 const fmrb_link_graphics_cursor_position_t *cmd = (const fmrb_link_graphics_cursor_position_t*)data;
+                cursor_mark_dirty();
                 g_cursor_x = cmd->x;
                 g_cursor_y = cmd->y;
+                cursor_mark_dirty();
                 GFX_LOG_D("Cursor position updated: (%d, %d)", g_cursor_x, g_cursor_y);
                 return 0;
             }
@@ -921,12 +3106,75 @@ extern "C" int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_ty
         case FMRB_LINK_GFX_CURSOR_SET_VISIBLE:
             if (size >= sizeof(fmrb_link_graphics_cursor_visible_t)) {
                 const fmrb_link_graphics_cursor_visible_t *cmd = (const fmrb_link_graphics_cursor_visible_t*)data;
-                g_cursor_visible = cmd->visible;
+                if (g_cursor_visible != cmd->visible) {
+                    g_cursor_visible = true;
+                    cursor_mark_dirty();
+                    g_cursor_visible = cmd->visible;
+                }
                 GFX_LOG_D("Cursor visibility updated: %s", g_cursor_visible ? "visible" : "hidden");
                 return 0;
             }
             break;
 
+        case FMRB_LINK_GFX_BATCH:
+            if (size >= sizeof(fmrb_link_graphics_batch_t)) {
+                const fmrb_link_graphics_batch_t *batch = (const fmrb_link_graphics_batch_t*)data;
+                const uint8_t *p = data + sizeof(fmrb_link_graphics_batch_t);
+                int failed = 0;
+
+                // The framing of every record is checked before any of them runs, so a
+                // malformed batch is rejected as a whole and draws nothing.
+                if (batch_validate(data, size) != 0) {
+                    return -1;
+                }
+
+                // Records that fail when applied are logged and skipped, and the batch
+                // still succeeds: a NACK would make the client retransmit the batch and
+                // draw the records that did succeed a second time.
+                for (uint16_t i = 0; i < batch->count; i++) {
+                    fmrb_link_graphics_batch_item_t item;
+                    memcpy(&item, p, sizeof(item));
+                    p += sizeof(item);
+                    if (graphics_execute_command(msg_type, item.cmd_type, seq, p, item.len) != 0) {
+                        failed++;
+                    }
+                    p += item.len;
+                }
+
+                if (failed) {
+                    GFX_LOG_E("BATCH: %d of %u records failed", failed, batch->count);
+                }
+                GFX_LOG_D("BATCH: %u records processed", batch->count);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_BEGIN_LIST:
+            if (size >= sizeof(fmrb_link_graphics_list_t)) {
+                const fmrb_link_graphics_list_t *cmd = (const fmrb_link_graphics_list_t*)data;
+                if (cmd->list_id == 0 || g_list_rec.list_id != 0) {
+                    GFX_LOG_E("BEGIN_LIST %u rejected (recording %u)", cmd->list_id, g_list_rec.list_id);
+                    return -1;
+                }
+                g_list_rec.list_id = cmd->list_id;
+                GFX_LOG_D("BEGIN_LIST %u", cmd->list_id);
+                return 0;
+            }
+            break;
+
+        case FMRB_LINK_GFX_END_LIST:
+            if (size >= sizeof(fmrb_link_graphics_list_t)) {
+                const fmrb_link_graphics_list_t *cmd = (const fmrb_link_graphics_list_t*)data;
+                return list_end(cmd->list_id);
+            }
+            break;
+
+        case FMRB_LINK_GFX_CALL_LIST:
+            if (size >= sizeof(fmrb_link_graphics_call_list_t)) {
+                return list_call(msg_type, seq, data);
+            }
+            break;
+
         default:
             GFX_LOG_E("Unknown graphics command: 0x%02x", cmd_type);
             return -1;
@@ -17,6 +17,12 @@ typedef enum {
     GFX_LOG_DEBUG = 3,    // Debug + Info + Error (verbose)
 } gfx_log_level_t;
 
+// Compositing modes
+typedef enum {
+    GFX_COMPOSITOR_AREA = 0,   // Recompose the bounding rectangle of the changed area
+    GFX_COMPOSITOR_TILES = 1,  // Recompose only the changed 32x32 tiles
+} gfx_compositor_t;
+
 /**
  * @brief Initialize graphics handler
  * @return 0 on success, -1 on error
@@ -29,16 +35,25 @@ int graphics_handler_init(void);
 void graphics_handler_cleanup(void);
 
 /**
- * @brief Process graphics command
+ * @brief Queue graphics command for the graphics task (called from the comm task)
+ * The command is copied and applied by graphics_handler_drain_commands(); errors
+ * found while applying it are logged. CREATE_CANVAS is acknowledged with its
+ * canvas ID here.
  * @param msg_type Message type (for ACK response)
  * @param cmd_type Graphics command type (from msgpack sub_cmd)
  * @param seq Sequence number
  * @param data Command data (structure only, no cmd_type prefix)
  * @param size Data size
- * @return 0 on success, -1 on error
+ * @return 0 if queued, -1 on error (not initialized, queue full)
  */
 int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_type, uint8_t seq, const uint8_t *data, size_t size);
 
+/**
+ * @brief Apply queued graphics commands (called from the graphics task at a frame boundary)
+ * @return Number of commands applied
+ */
+int graphics_handler_drain_commands(void);
+
 // SDL renderer functions removed - not needed in abstracted interface
 
 /**
@@ -48,11 +63,27 @@ int graphics_handler_process_command(uint8_t msg_type, uint8_t cmd_type, uint8_t
 void graphics_handler_set_log_level(int level);
 
 /**
- * @brief Render all canvases to screen in Z-order
+ * @brief Select the compositing mode (call from the graphics task)
+ * GFX_COMPOSITOR_AREA recomposes one bounding rectangle around everything that
+ * changed, culling occluded canvas parts. GFX_COMPOSITOR_TILES bins the visible
+ * canvases into 32x32 screen tiles and recomposes only tiles whose content or
+ * canvas list changed, so scattered small updates stay cheap. On Linux the
+ * initial mode can be set with FMRB_COMPOSITOR=tiles.
+ * @param mode Compositing mode
+ * @return 0 on success, -1 on failure (the mode is unchanged)
+ */
+int graphics_handler_set_compositor(gfx_compositor_t mode);
+
+/**
+ * @brief Render all canvases to screen in Z-order and update the display
  * This function composites all visible canvases to the screen based on their Z-order.
+ * Only the screen area changed since the last call (presented drawing, moved,
+ * resized, restacked or deleted canvases, cursor) is recomposed, and only the
+ * bounding rectangle of everything changed is passed to display(x, y, w, h).
  * Should be called periodically (e.g., every frame in main loop).
+ * @return 1 if the display was updated, 0 if nothing changed
  */
-void graphics_handler_render_frame(void);
+int graphics_handler_render_frame(void);
 
 #ifdef __cplusplus
 }
@@ -3,65 +3,36 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "comm_interface.h"
+#include "fmrb_link_bench.h"
 
 static const char *TAG = "comm_task";
 static volatile int task_running = 1;
 
-void comm_test(void) {
-  printf("SPI task started on core %d\n", (int)xPortGetCoreID());
-
-  const comm_interface_t* comm = comm_get_interface();
-
-  // SPI初期化
-  if (comm->init() != 0) {
-    printf("SPI initialization failed!\n");
-    vTaskDelete(NULL);
-    return;
-  }
-
-  printf("SPI initialized successfully, starting communication loop...\n");
-
-  // テスト用のダミーデータ
-  uint8_t test_data[] = {0xAA, 0x55, 0x01, 0x02, 0x03, 0x04};
-  int send_count = 0;
-
-  while (task_running) {
-    // 通信処理
-    int processed = comm->process();
-    if (processed < 0) {
-      printf("SPI process error\n");
-    }
-
-    // 5秒ごとにテストデータを送信
-    send_count++;
-    if (send_count >= 500) {  // 10ms * 500 = 5秒
-      printf("SPI: Sending test data...\n");
-      int sent = comm->send(test_data, sizeof(test_data));
-      if (sent > 0) {
-        printf("SPI: Sent %d bytes\n", sent);
-      } else {
-        printf("SPI: Send failed\n");
-      }
-      send_count = 0;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(10));
-  }
-}
+// Upper bound on a blocking wait, so task_running is rechecked even without a wake-up
+#define COMM_WAIT_TIMEOUT_MS 100
 
 void comm_task_stop(void) {
     task_running = 0;
+
+    // Unblock comm->wait() (called from the signal handler on Linux)
+    const comm_interface_t *comm = comm_get_interface();
+    if (comm && comm->wakeup) {
+        comm->wakeup();
+    }
 }
 
 void comm_task(void *pvParameters) {
     ESP_LOGI(TAG, "Communication task started on core %d", (int)xPortGetCoreID());
 
-#ifndef CONFIG_IDF_TARGET_LINUX
-    //testing SPI
-    comm_test();
-    return;
-#else
-    // Linux: Use comm_interface for socket communication
+    // Link layer microbenchmarks (FMRB_BENCH=crc32,cobs_crc)
+    if (fmrb_link_bench_enabled("crc32")) {
+        fmrb_link_bench_crc32();
+    }
+    if (fmrb_link_bench_enabled("cobs_crc")) {
+        fmrb_link_bench_cobs_crc();
+    }
+
+    // Socket server or simulated SPI on Linux, SPI slave on ESP32
     const comm_interface_t *comm = COMM_INTERFACE;
     if (!comm) {
         ESP_LOGE(TAG, "Failed to get communication interface");
@@ -69,7 +40,7 @@ void comm_task(void *pvParameters) {
         return;
     }
 
-    // Initialize communication interface (socket server)
+    // Initialize communication interface
     if (comm->init() < 0) {
         ESP_LOGE(TAG, "Communication interface initialization failed");
         vTaskDelete(NULL);
@@ -78,8 +49,33 @@ void comm_task(void *pvParameters) {
 
     ESP_LOGI(TAG, "Communication interface initialized successfully");
 
+    // ACK round-trip latency (FMRB_BENCH=ack_latency; runs a loopback client,
+    // no other client must be connected)
+    if (fmrb_link_bench_enabled("ack_latency")) {
+        fmrb_link_bench_ack_latency_start();
+    }
+    // Simulated SPI link latency/throughput (FMRB_BENCH=spi_sim with FMRB_COMM=spi_sim)
+    if (fmrb_link_bench_enabled("spi_sim")) {
+        fmrb_link_bench_spi_sim_start();
+    }
+
     // Main communication processing loop
     while (task_running) {
+        if (comm->wait) {
+            // Sleep until a command arrives so it is handled immediately
+            int ready = comm->wait(COMM_WAIT_TIMEOUT_MS);
+            if (ready < 0) {
+                vTaskDelay(pdMS_TO_TICKS(16));
+            } else if (ready == 0) {
+                // Timeout or interrupted wait: a blocking poll() is invisible to the
+                // scheduler (Linux port), so yield a tick to lower-priority tasks
+                vTaskDelay(1);
+            }
+            if (ready <= 0) {
+                continue;
+            }
+        }
+
         // Process incoming messages
         int result = comm->process();
 
@@ -87,8 +83,10 @@ void comm_task(void *pvParameters) {
             //ESP_LOGW(TAG, "Communication process error");
         }
 
-        // Small delay to prevent busy waiting (~60 FPS)
-        vTaskDelay(pdMS_TO_TICKS(16));
+        if (!comm->wait) {
+            // Small delay to prevent busy waiting (~60 FPS)
+            vTaskDelay(pdMS_TO_TICKS(16));
+        }
     }
 
     // Cleanup communication interface
@@ -96,5 +94,4 @@ void comm_task(void *pvParameters) {
 
     ESP_LOGI(TAG, "Communication task stopped");
     vTaskDelete(NULL);
-#endif
 }
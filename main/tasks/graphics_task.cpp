@@ -49,6 +49,8 @@ extern void gfx_test(void);
 
 #include "display_interface.h"
 #include "graphics_handler.h"
+#include "graphics_bench.h"
+#include "fmrb_link_bench.h"
 
 extern "C" {
 #include "input_handler.h"
@@ -111,6 +113,13 @@ extern "C" int init_display_callback(uint16_t width, uint16_t height, uint8_t co
         return -1;
     }
 
+    // Compositor blit kernels and glyph atlas vs LovyanGFX (FMRB_BENCH=blit,text)
+    if (fmrb_link_bench_enabled("blit")) {
+        graphics_bench_blit();
+    }
+    if (fmrb_link_bench_enabled("text")) {
+        graphics_bench_text();
+    }
 
     // Initialize input handler
 #ifdef CONFIG_IDF_TARGET_LINUX
@@ -174,11 +183,11 @@ void graphics_task(void *pvParameters) {
         }
 #endif
 
-        // Render all canvases to screen in Z-order
-        graphics_handler_render_frame();
+        // Apply commands queued by comm_task since the last frame
+        graphics_handler_drain_commands();
 
-        // Update display
-        g_lgfx->display();
+        // Render changed areas in Z-order and update the display (no-op when idle)
+        graphics_handler_render_frame();
 
         // Small delay to prevent busy waiting
         lgfx::delay(16); // ~60 FPS
@@ -49,6 +49,58 @@ namespace lgfx
 
   static std::list<monitor_t*> _list_monitor;
 
+  /// Framebuffer rows to upload at the next texture update (y1 exclusive).
+  /// Panel_sdl.hpp is not part of the patch set, so each panel keeps its band in
+  /// a header in front of its own _texturebuf (see initFrameBuffer), accessed
+  /// with the panel's _sdl_mutex held.
+  struct dirty_band_t { int32_t y0; int32_t y1; };
+
+  static dirty_band_t* texture_band(rgb888_t* texturebuf)
+  {
+    return texturebuf ? reinterpret_cast<dirty_band_t*>(texturebuf) - 1 : nullptr;
+  }
+
+  static void mark_dirty_rows(dirty_band_t* band, int32_t y, int32_t h)
+  {
+    if (band == nullptr || h <= 0) { return; }
+    if (band->y0 >= band->y1) {
+      band->y0 = y;
+      band->y1 = y + h;
+    } else {
+      if (y < band->y0) { band->y0 = y; }
+      if (y + h > band->y1) { band->y1 = y + h; }
+    }
+  }
+
+  /// Mark a rectangle in panel coordinates: map it to framebuffer rows the same
+  /// way Panel_FrameBufferBase applies the internal rotation (width/height are
+  /// the rotated panel size)
+  static void mark_dirty_rect(dirty_band_t* band, uint_fast8_t r, int32_t width, int32_t height,
+                              int32_t x, int32_t y, int32_t w, int32_t h)
+  {
+    if (w <= 0 || h <= 0) { return; }
+    if (r)
+    {
+      if ((1u << r) & 0b10010110) { y = height - (y + h); }
+      if (r & 2)                  { x = width  - (x + w); }
+      if (r & 1) { y = x; h = w; }  // Panel columns are framebuffer rows
+    }
+    mark_dirty_rows(band, y, h);
+  }
+
+  /// Take and reset the dirty band, clipped to the panel height
+  static void take_dirty_rows(dirty_band_t* band, int32_t height, int32_t* y0, int32_t* y1)
+  {
+    if (band == nullptr) {
+      *y0 = 0;
+      *y1 = height;
+      return;
+    }
+    *y0 = band->y0 < 0 ? 0 : band->y0;
+    *y1 = band->y1 > height ? height : band->y1;
+    band->y0 = band->y1 = 0;
+  }
+
   static monitor_t* const getMonitorByWindowID(uint32_t windowID)
   {
     for (auto& m : _list_monitor)
@@ -401,45 +453,60 @@ namespace lgfx
   void Panel_sdl::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
     lock_t lock(this);
+    mark_dirty_rect(texture_band(_texturebuf), _internal_rotation, _width, _height, x, y, 1, 1);
     Panel_FrameBufferBase::drawPixelPreclipped(x, y, rawcolor);
   }
 
   void Panel_sdl::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
     lock_t lock(this);
+    mark_dirty_rect(texture_band(_texturebuf), _internal_rotation, _width, _height, x, y, w, h);
     Panel_FrameBufferBase::writeFillRectPreclipped(x, y, w, h, rawcolor);
   }
 
   void Panel_sdl::writeBlock(uint32_t rawcolor, uint32_t length)
   {
 //    lock_t lock(this);
+    // Written rows depend on the address window: upload the whole framebuffer
+    SDL_LockMutex(_sdl_mutex);
+    mark_dirty_rows(texture_band(_texturebuf), 0, INT32_MAX);
+    SDL_UnlockMutex(_sdl_mutex);
     Panel_FrameBufferBase::writeBlock(rawcolor, length);
   }
 
   void Panel_sdl::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
     lock_t lock(this);
+    mark_dirty_rect(texture_band(_texturebuf), _internal_rotation, _width, _height, x, y, w, h);
     Panel_FrameBufferBase::writeImage(x, y, w, h, param, use_dma);
   }
 
   void Panel_sdl::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
   {
     lock_t lock(this);
+    mark_dirty_rect(texture_band(_texturebuf), _internal_rotation, _width, _height, x, y, w, h);
     Panel_FrameBufferBase::writeImageARGB(x, y, w, h, param);
   }
 
   void Panel_sdl::writePixels(pixelcopy_t* param, uint32_t len, bool use_dma)
   {
     lock_t lock(this);
+    mark_dirty_rows(texture_band(_texturebuf), 0, INT32_MAX);  // Rows depend on the address window
     Panel_FrameBufferBase::writePixels(param, len, use_dma);
   }
 
   void Panel_sdl::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
   {
-    (void)x;
-    (void)y;
-    (void)w;
-    (void)h;
+    // Writes already mark their rows; an explicit area is uploaded as well, so
+    // it is refreshed even when it was changed without going through the panel.
+    // display() without an area (w or h == 0) relies on the tracked writes.
+    if (w && h)
+    {
+      SDL_LockMutex(_sdl_mutex);
+      mark_dirty_rect(texture_band(_texturebuf), _internal_rotation, _width, _height, x, y, w, h);
+      ++_modified_counter;
+      SDL_UnlockMutex(_sdl_mutex);
+    }
     if (_in_step_exec)
     {
       if (_display_counter != _modified_counter) {
@@ -558,14 +625,21 @@ namespace lgfx
       if (0 == SDL_LockMutex(_sdl_mutex))
       {
         _texupdate_counter = _modified_counter;
-        for (int y = 0; y < _cfg.panel_height; ++y)
+        // Convert and upload only the band of rows written since the last update
+        int32_t y0, y1;
+        take_dirty_rows(texture_band(_texturebuf), _cfg.panel_height, &y0, &y1);
+        for (int y = y0; y < y1; ++y)
         {
           pc.src_x32 = 0;
           pc.src_data = _lines_buffer[y];
           pc.fp_copy(&_texturebuf[y * _cfg.panel_width], 0, _cfg.panel_width, &pc);
         }
         SDL_UnlockMutex(_sdl_mutex);
-        SDL_UpdateTexture(monitor.texture, nullptr, _texturebuf, _cfg.panel_width * sizeof(rgb888_t));
+        if (y0 < y1)
+        {
+          SDL_Rect band = { 0, y0, (int)_cfg.panel_width, y1 - y0 };
+          SDL_UpdateTexture(monitor.texture, &band, &_texturebuf[y0 * _cfg.panel_width], _cfg.panel_width * sizeof(rgb888_t));
+        }
       }
     }
 
@@ -647,7 +721,11 @@ namespace lgfx
     uint8_t** lineArray = (uint8_t**)heap_alloc_dma(height * sizeof(uint8_t*));
     if ( nullptr == lineArray ) { return false; }
 
-    _texturebuf = (rgb888_t*)heap_alloc_dma(width * height * sizeof(rgb888_t));
+    // The dirty band header sits in front of the pixels (see texture_band)
+    auto band = (dirty_band_t*)heap_alloc_dma(sizeof(dirty_band_t) + width * height * sizeof(rgb888_t));
+    if ( nullptr == band ) { heap_free(lineArray); return false; }
+    *band = { 0, (int32_t)height };
+    _texturebuf = reinterpret_cast<rgb888_t*>(band + 1);
 
     /// 8byte alignment;
     width = (width + 7) & ~7u;
@@ -678,7 +756,7 @@ namespace lgfx
       heap_free(lines);
     }
     if (_texturebuf) {
-      heap_free(_texturebuf);
+      heap_free(texture_band(_texturebuf));
       _texturebuf = nullptr;
     }
   }